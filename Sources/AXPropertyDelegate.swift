@@ -8,11 +8,17 @@ class AXPropertyDelegate<T: Equatable, UIElement: UIElementType>: PropertyDelega
     let axElement: UIElement
     let attribute: AXSwift.Attribute
     let initPromise: Promise<InitDict>
+    // Where requests are counted for `State.health()`.
+    let activity: ProcessActivity?
 
-    init(_ axElement: UIElement, _ attribute: AXSwift.Attribute, _ initPromise: Promise<InitDict>) {
+    init(_ axElement: UIElement,
+         _ attribute: AXSwift.Attribute,
+         _ initPromise: Promise<InitDict>,
+         activity: ProcessActivity? = nil) {
         self.axElement = axElement
         self.attribute = attribute
         self.initPromise = initPromise
+        self.activity = activity
     }
 
     func readFilter(_ value: T?) -> T? {
@@ -21,7 +27,8 @@ class AXPropertyDelegate<T: Equatable, UIElement: UIElementType>: PropertyDelega
 
     func readValue() throws -> T? {
         do {
-            let value: T? = try traceRequest(axElement, "attribute", attribute) {
+            let value: T? = try traceRequest(axElement, "attribute", attribute,
+                                             activity: activity) {
                 try axElement.attribute(attribute)
             }
             return readFilter(value)
@@ -46,7 +53,8 @@ class AXPropertyDelegate<T: Equatable, UIElement: UIElementType>: PropertyDelega
 
     func writeValue(_ newValue: T) throws {
         do {
-            return try traceRequest(axElement, "setAttribute", attribute, newValue) {
+            return try traceRequest(axElement, "setAttribute", attribute, newValue,
+                                    activity: activity) {
                 try axElement.setAttribute(attribute, value: newValue)
             }
         } catch AXError.illegalArgument {
@@ -70,6 +78,11 @@ class AXPropertyDelegate<T: Equatable, UIElement: UIElementType>: PropertyDelega
         }
     }
 
+    func readValue(from attributes: InitDict) -> T? {
+        guard let value = attributes[attribute] else { return nil }
+        return readFilter(value as? T)
+    }
+
     func initialize() -> Promise<T?> {
         return initPromise.map { dict in
             guard let value = dict[self.attribute] else {
@@ -96,11 +109,6 @@ class AXPropertyDelegate<T: Equatable, UIElement: UIElementType>: PropertyDelega
 
 // Non-generic protocols of generic types make it easy to store (or cast) objects.
 
-protocol AXPropertyDelegateType {
-    var attribute: AXSwift.Attribute { get }
-}
-extension AXPropertyDelegate: AXPropertyDelegateType {}
-
 protocol PropertyType {
     func issueRefresh()
     var delegate: Any { get }
@@ -112,14 +120,24 @@ extension Property: PropertyType {
     }
 }
 
+/// A property that can be updated by polling.
+protocol PropertyPollable {
+    var changeSequence: Int { get }
+    func update(fromPolled attributes: [AXSwift.Attribute: Any], ifUnchangedSince sequence: Int)
+        -> Bool
+}
+extension Property: PropertyPollable {}
+
 /// Asynchronously fetches all the element attributes.
 func fetchAttributes<UIElement: UIElementType>(_ attributeNames: [Attribute],
                                                forElement axElement: UIElement,
+                                               activity: ProcessActivity?,
                                                after: Promise<Void>,
                                                seal: Resolver<[Attribute: Any]>) {
     // Issue a request in the background.
     after.done(on: .global()) {
-        let attributes = try traceRequest(axElement, "getMultipleAttributes", attributeNames) {
+        let attributes = try traceRequest(axElement, "getMultipleAttributes", attributeNames,
+                                          activity: activity) {
             try axElement.getMultipleAttributes(attributeNames)
         }
         seal.fulfill(attributes)
@@ -128,6 +146,163 @@ func fetchAttributes<UIElement: UIElementType>(_ attributeNames: [Attribute],
     }
 }
 
+/// Attributes of an element that are read in one request the first time any of them is needed,
+/// for properties that are initialized lazily. `fetched` serves as the properties' initial
+/// attribute values, and is fulfilled by the first read that succeeds. A read that fails isn't
+/// kept. Once one has failed, `get` no longer reads on the caller's thread; reads are retried in
+/// the background with `retry`, at most once per backoff delay.
+final class LazyAttributes {
+    // How long to wait after a failed read before retrying in the background. Doubles with each
+    // failure that follows, up to `maximumRetryDelay`.
+    var retryDelay: TimeInterval = 0.5
+    var maximumRetryDelay: TimeInterval = 30
+
+    let fetched: Promise<[Attribute: Any]>
+    private let seal: Resolver<[Attribute: Any]>
+    private let read: () throws -> [Attribute: Any]
+
+    // One read of the attributes. `done` is signaled once `result` is set.
+    private final class Attempt {
+        let (promise, seal) = Promise<[Attribute: Any]>.pending()
+        let done = DispatchSemaphore(value: 0)
+        var result: Swift.Result<[Attribute: Any], Error>!
+    }
+
+    private let lock = NSLock()
+    private var attributes: [Attribute: Any]?
+    private var inFlight: Attempt?
+    // The error of the last read, if it failed, and when the next retry may start.
+    private var lastError: Error?
+    private var retryBackoff: TimeInterval?
+    private var retryAfter = Date.distantPast
+
+    init<UIElement: UIElementType>(_ attributeNames: [Attribute],
+                                   forElement axElement: UIElement,
+                                   activity: ProcessActivity?) {
+        (fetched, seal) = Promise<[Attribute: Any]>.pending()
+        read = {
+            do {
+                return try traceRequest(axElement, "getMultipleAttributes", attributeNames,
+                                        activity: activity) {
+                    try axElement.getMultipleAttributes(attributeNames)
+                }
+            } catch AXError.cannotComplete {
+                // If messaging timeout unspecified, we'll pass -1.
+                var time = UIElement.globalMessagingTimeout
+                if time == 0 {
+                    time = -1.0
+                }
+                throw PropertyError.timeout(time: TimeInterval(time))
+            } catch let error {
+                throw PropertyError.invalidObject(cause: error)
+            }
+        }
+    }
+
+    /// Starts reading the attributes in the background, unless they have been read already.
+    /// Returns the read in flight, or `nil` if the attributes have been read.
+    @discardableResult
+    func request() -> Promise<[Attribute: Any]>? {
+        let (attempt, started) = begin()
+        guard let inFlight = attempt else { return nil }
+        if started {
+            DispatchQueue.global().async { self.perform(inFlight) }
+        }
+        return inFlight.promise
+    }
+
+    /// Starts reading the attributes again in the background if the last read failed and its
+    /// backoff delay has passed. Returns the read, or `nil` if none was started.
+    @discardableResult
+    func retry() -> Promise<[Attribute: Any]>? {
+        lock.lock()
+        guard attributes == nil, inFlight == nil, lastError != nil, Date() >= retryAfter else {
+            lock.unlock()
+            return nil
+        }
+        let attempt = Attempt()
+        inFlight = attempt
+        lock.unlock()
+        DispatchQueue.global().async { self.perform(attempt) }
+        return attempt.promise
+    }
+
+    /// Returns the attributes. Until a read has failed, reads them on this thread if no read is in
+    /// flight, or waits for the read in flight. After that, throws the last read's error without
+    /// blocking; see `retry`.
+    func get() throws -> [Attribute: Any] {
+        lock.lock()
+        if let attributes = attributes {
+            lock.unlock()
+            return attributes
+        }
+        if let error = lastError {
+            lock.unlock()
+            throw error
+        }
+        lock.unlock()
+
+        let (attempt, started) = begin()
+        guard let inFlight = attempt else {
+            lock.lock()
+            defer { lock.unlock() }
+            return attributes!
+        }
+        if started {
+            return try perform(inFlight).get()
+        }
+        inFlight.done.wait()
+        // Let any other waiters through.
+        inFlight.done.signal()
+        return try inFlight.result.get()
+    }
+
+    // Returns the read in flight, or nil if the attributes have been read, and whether the caller
+    // started the read and should perform it.
+    private func begin() -> (Attempt?, Bool) {
+        lock.lock()
+        defer { lock.unlock() }
+        if attributes != nil {
+            return (nil, false)
+        }
+        if let attempt = inFlight {
+            return (attempt, false)
+        }
+        let attempt = Attempt()
+        inFlight = attempt
+        return (attempt, true)
+    }
+
+    @discardableResult
+    private func perform(_ attempt: Attempt) -> Swift.Result<[Attribute: Any], Error> {
+        let result = Swift.Result { try read() }
+        attempt.result = result
+        lock.lock()
+        switch result {
+        case .success(let attributes):
+            self.attributes = attributes
+            lastError = nil
+        case .failure(let error):
+            lastError = error
+            let delay = retryBackoff.map { min(maximumRetryDelay, $0 * 2) } ?? retryDelay
+            retryBackoff = delay
+            retryAfter = Date(timeIntervalSinceNow: delay)
+        }
+        inFlight = nil
+        lock.unlock()
+        attempt.done.signal()
+
+        switch result {
+        case .success(let attributes):
+            attempt.seal.fulfill(attributes)
+            seal.fulfill(attributes)
+        case .failure(let error):
+            attempt.seal.reject(error)
+        }
+        return result
+    }
+}
+
 /// Returns a promise that resolves when all the provided properties are initialized.
 /// Adds additional error information for AXPropertyDelegates.
 func initializeProperties(_ properties: [PropertyType]) -> Promise<Void> {
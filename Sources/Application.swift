@@ -28,7 +28,18 @@ public final class Application {
     }
 
     public var processIdentifier: pid_t { return delegate.processIdentifier }
-    public var bundleIdentifier: String? { return delegate.bundleIdentifier }
+    public var bundleIdentifier: String? { return delegate.metadata.bundleIdentifier }
+
+    /// The localized name of the application, e.g. "Safari".
+    public var localizedName: String? { return delegate.metadata.localizedName }
+
+    /// The activation policy of the application when Swindler started watching it.
+    public var activationPolicy: NSApplication.ActivationPolicy {
+        return delegate.metadata.activationPolicy
+    }
+
+    /// When the application was launched, if known.
+    public var launchDate: Date? { return delegate.metadata.launchDate }
 
     /// The global Swindler state.
     public var swindlerState: State { return state_ }
@@ -36,6 +47,7 @@ public final class Application {
     /// The known windows of the application. Windows on spaces that we haven't seen yet aren't
     /// included.
     public var knownWindows: [Window] {
+        DependencyTracker.shared.recordRead(.collection(.windows))
         return delegate.knownWindows.compactMap({ Window(delegate: $0) })
     }
 
@@ -67,18 +79,56 @@ extension Application: CustomStringConvertible {
     }
 }
 
+/// Information about an application that doesn't change while it runs.
+///
+/// Captured once when the application is first watched, so reading it never has to go through
+/// LaunchServices.
+struct ApplicationMetadata {
+    var bundleIdentifier: String?
+    var localizedName: String?
+    var activationPolicy: NSApplication.ActivationPolicy = .regular
+    var launchDate: Date?
+}
+
+extension ApplicationMetadata {
+    init(_ app: NSRunningApplication) {
+        self.init(bundleIdentifier: app.bundleIdentifier,
+                  localizedName: app.localizedName,
+                  activationPolicy: app.activationPolicy,
+                  launchDate: app.launchDate)
+    }
+}
+
 protocol ApplicationDelegate: AnyObject {
     var processIdentifier: pid_t! { get }
-    var bundleIdentifier: String? { get }
+    var metadata: ApplicationMetadata { get }
 
     var stateDelegate: StateDelegate? { get }
 
     var knownWindows: [WindowDelegate] { get }
+    func forEachWindowDelegate(_ body: (WindowDelegate) throws -> Void) rethrows
 
     var mainWindow: WriteableProperty<OfOptionalType<Window>>! { get }
     var focusedWindow: Property<OfOptionalType<Window>>! { get }
     var isHidden: WriteableProperty<OfType<Bool>>! { get }
 
+    var extensions: ExtensionStorage { get set }
+
+    /// Counts requests to the application, for `State.health()`. Shared with its windows.
+    var activity: ProcessActivity { get }
+
+    /// See `State.health()`. Only called on the main thread.
+    var health: ApplicationHealth { get }
+
+    /// Called when one of the application's windows becomes invalid without being destroyed, so
+    /// that it can be removed if it is gone.
+    func windowDidBecomeInvalid()
+
+    /// Reads the application's window list and starts tracking the windows in it that aren't known
+    /// yet, without emitting a `WindowCreatedEvent` for them. Resolves to the newly tracked windows
+    /// and the known windows that were in the list.
+    func discoverWindows() -> Promise<(discovered: [WindowDelegate], listed: [WindowDelegate])>
+
     func equalTo(_ other: ApplicationDelegate) -> Bool
 }
 
@@ -99,6 +149,9 @@ final class OSXApplicationDelegate<
 
     internal let axElement: UIElement // internal for testing only
     internal var observer: Observer! // internal for testing only
+    // When set, the observer delivers its callbacks on this thread, through `notificationBatcher`.
+    private let observerThread: ObserverThread?
+    private var notificationBatcher: NotificationBatcher<Observer.Context, UIElement>?
     fileprivate var windows: [WinDelegate] = []
 
     // Used internally for deferring code until an OSXWindowDelegate has been initialized for a
@@ -107,39 +160,78 @@ final class OSXApplicationDelegate<
 
     fileprivate var initialized: Promise<Void>!
 
+    // Windows created since the last WindowsCreatedEvent.
+    fileprivate var pendingCreatedWindows: [WinDelegate] = []
+    /// How long to wait for more windows after one is created, before sending a
+    /// WindowsCreatedEvent.
+    var windowsCreatedInterval: TimeInterval = 0.05
+
+    // How long to wait for a destroyed notification after a window becomes invalid, before
+    // probing it.
+    var reapDelay: TimeInterval = 0.5
+    // The longest delay between probes of windows that don't answer.
+    var maximumReapDelay: TimeInterval = 30
+    // The most windows probed at once.
+    var maximumReapProbes = 4
+    private var isReapScheduled = false
+    private var isReaping = false
+    private var reapBackoff: TimeInterval?
+    private(set) var reapedWindowCount = 0
+
     var mainWindow: WriteableProperty<OfOptionalType<Window>>!
     var focusedWindow: Property<OfOptionalType<Window>>!
     var isHidden: WriteableProperty<OfType<Bool>>!
 
+    var extensions = ExtensionStorage()
+
     var processIdentifier: pid_t!
-    lazy var runningApplication: NSRunningApplication =
-        NSRunningApplication(processIdentifier: self.processIdentifier)!
-    lazy var bundleIdentifier: String? =
-        self.runningApplication.bundleIdentifier
+    let metadata: ApplicationMetadata
+
+    let activity = ProcessActivity()
+
+    var health: ApplicationHealth {
+        assert(Thread.current.isMainThread)
+        return activity.health(processIdentifier: processIdentifier,
+                               bundleIdentifier: metadata.bundleIdentifier,
+                               deferredWindowHandlers: newWindowHandler.count,
+                               reapedWindows: reapedWindowCount)
+    }
 
     var knownWindows: [WindowDelegate] {
         return windows.map({ $0 as WindowDelegate })
     }
+    func forEachWindowDelegate(_ body: (WindowDelegate) throws -> Void) rethrows {
+        for window in windows {
+            try body(window)
+        }
+    }
 
     /// Initializes the object and returns it as a Promise that resolves once it's ready.
     static func initialize(
         axElement: ApplicationElement,
         stateDelegate: StateDelegate,
-        notifier: EventNotifier
+        notifier: EventNotifier,
+        metadata: ApplicationMetadata = ApplicationMetadata(),
+        observerThread: ObserverThread? = nil
     ) -> Promise<OSXApplicationDelegate> {
         return firstly { () -> Promise<OSXApplicationDelegate> in // capture thrown errors in promise chain
-            let appDelegate = try OSXApplicationDelegate(axElement, stateDelegate, notifier)
+            let appDelegate = try OSXApplicationDelegate(
+                axElement, stateDelegate, notifier, metadata, observerThread)
             return appDelegate.initialized.map { appDelegate }
         }
     }
 
     private init(_ axElement: ApplicationElement,
          _ stateDelegate: StateDelegate,
-         _ notifier: EventNotifier) throws {
+         _ notifier: EventNotifier,
+         _ metadata: ApplicationMetadata,
+         _ observerThread: ObserverThread?) throws {
         // TODO: filter out applications by activation policy
         self.axElement = axElement.toElement
         self.stateDelegate = stateDelegate
         self.notifier = notifier
+        self.metadata = metadata
+        self.observerThread = observerThread
         processIdentifier = try axElement.pid()
 
         let notifications: [AXNotification] = [
@@ -169,22 +261,27 @@ final class OSXApplicationDelegate<
             MainWindowPropertyDelegate(axElement,
                                        windowFinder: self,
                                        windowDelegate: WinDelegate.self,
-                                       initProperties),
+                                       initProperties,
+                                       activity: activity),
             withEvent: ApplicationMainWindowChangedEvent.self,
             receivingObject: Application.self,
-            notifier: self)
+            notifier: self,
+            locks: PropertyLocks(activity: activity))
         focusedWindow = Property(
-            WindowPropertyAdapter(AXPropertyDelegate(axElement, .focusedWindow, initProperties),
+            WindowPropertyAdapter(AXPropertyDelegate(axElement, .focusedWindow, initProperties,
+                                                     activity: activity),
                                   windowFinder: self,
                                   windowDelegate: WinDelegate.self),
             withEvent: ApplicationFocusedWindowChangedEvent.self,
             receivingObject: Application.self,
-            notifier: self)
+            notifier: self,
+            locks: PropertyLocks(activity: activity))
         isHidden = WriteableProperty(
-            AXPropertyDelegate(axElement, .hidden, initProperties),
+            AXPropertyDelegate(axElement, .hidden, initProperties, activity: activity),
             withEvent: ApplicationIsHiddenChangedEvent.self,
             receivingObject: Application.self,
-            notifier: self)
+            notifier: self,
+            locks: PropertyLocks(activity: activity))
 
         let properties: [PropertyType] = [
             mainWindow,
@@ -200,6 +297,7 @@ final class OSXApplicationDelegate<
         // Fetch attribute values, after subscribing to notifications so there are no gaps.
         fetchAttributes(attributes,
                         forElement: axElement,
+                        activity: activity,
                         after: appWatched,
                         seal: attrsSeal)
 
@@ -210,16 +308,32 @@ final class OSXApplicationDelegate<
     fileprivate func watchApplicationElement(_ notifications: [AXNotification]) -> Promise<Void> {
         do {
             weak var weakSelf = self
-            observer = try Observer(processID: processIdentifier, callback: { o, e, n in
-                weakSelf?.handleEvent(observer: o, element: e, notification: n)
-            })
+            if let thread = observerThread {
+                // The observer calls back on the run loop it is created on. Callbacks are handed
+                // to the main thread in batches, in order.
+                let batcher = NotificationBatcher<Observer.Context, UIElement> { o, e, n in
+                    // Drop what was still queued when the application terminated.
+                    guard let delegate = weakSelf, delegate.observer != nil else { return }
+                    delegate.handleEvent(observer: o, element: e, notification: n)
+                }
+                notificationBatcher = batcher
+                let pid: pid_t = processIdentifier
+                observer = try thread.sync {
+                    try Observer(processID: pid, callback: batcher.enqueue)
+                }
+            } else {
+                observer = try Observer(processID: processIdentifier, callback: { o, e, n in
+                    weakSelf?.handleEvent(observer: o, element: e, notification: n)
+                })
+            }
         } catch {
             return Promise(error: error)
         }
 
         return Promise.value(()).done(on: .global()) {
             for notification in notifications {
-                try traceRequest(self.axElement, "addNotification", notification) {
+                try traceRequest(self.axElement, "addNotification", notification,
+                                 activity: self.activity) {
                     try self.observer.addNotification(notification, forElement: self.axElement)
                 }
             }
@@ -231,7 +345,8 @@ final class OSXApplicationDelegate<
     fileprivate func fetchWindows(after promise: Promise<Void>) -> Promise<Void> {
         return promise.map(on: .global()) { () -> [UIElement]? in
             // Fetch the list of window elements.
-            try traceRequest(self.axElement, "arrayAttribute", AXSwift.Attribute.windows) {
+            try traceRequest(self.axElement, "arrayAttribute", AXSwift.Attribute.windows,
+                             activity: self.activity) {
                 return try self.axElement.arrayAttribute(.windows)
             }
         }.then { maybeWindowElements -> Promise<Void> in
@@ -268,7 +383,8 @@ final class OSXApplicationDelegate<
         }
         return WinDelegate.initialize(
             appDelegate: self, notifier: notifier, axElement: axElement, observer: observer,
-            systemScreens: systemScreens
+            systemScreens: systemScreens,
+            lazyProperties: stateDelegate?.configuration.lazyWindowProperties ?? false
         ).map { windowDelegate in
             // This check needs to happen here, because it's possible (though rare) to call this
             // method from two different places (fetchWindows and onWindowCreated) before
@@ -278,6 +394,7 @@ final class OSXApplicationDelegate<
             }
 
             self.windows.append(windowDelegate)
+            DependencyTracker.shared.changed(.collection(.windows))
             self.newWindowHandler.windowCreated(axElement)
 
             return windowDelegate
@@ -290,6 +407,46 @@ final class OSXApplicationDelegate<
         }
     }
 
+    /// Releases extension data on the application and its windows, and forgets its windows and
+    /// deferred work. Called once the application has terminated.
+    func releaseResources() {
+        extensions.removeAll()
+        for window in windows {
+            window.extensions.removeAll()
+        }
+        windows = []
+        newWindowHandler = NewWindowHandler()
+        pendingCreatedWindows = []
+
+        // An observer removes itself from the run loop of the thread it is released on, so
+        // release it on its own thread. Waiting for that means no callback can arrive afterwards.
+        if let thread = observerThread {
+            notificationBatcher?.removeAll()
+            try? thread.sync { self.observer = nil }
+        }
+    }
+
+    /// The estimated memory used by deferred new window handlers.
+    var deferredWindowHandlerCost: Int {
+        return newWindowHandler.count * NewWindowHandler<UIElement>.estimatedCostPerHandler
+    }
+
+    /// Drops the oldest deferred new window handlers until `bytes` bytes are freed. Returns the
+    /// number of bytes freed.
+    ///
+    /// A dropped handler may have been waiting to refresh `mainWindow` or `focusedWindow`, so both
+    /// are refreshed now instead. Window notifications deferred by dropped handlers don't need
+    /// replaying, since a window reads its attributes when it is created.
+    func evictDeferredWindowHandlers(bytes: Int) -> Int {
+        let costPerHandler = NewWindowHandler<UIElement>.estimatedCostPerHandler
+        let count = min(newWindowHandler.count, (bytes + costPerHandler - 1) / costPerHandler)
+        guard count > 0 else { return 0 }
+        newWindowHandler.dropOldest(count)
+        mainWindow.refresh()
+        focusedWindow.refresh()
+        return count * costPerHandler
+    }
+
     func equalTo(_ rhs: ApplicationDelegate) -> Bool {
         if let other = rhs as? OSXApplicationDelegate {
             return axElement == other.axElement
@@ -337,10 +494,57 @@ extension OSXApplicationDelegate {
             else { return nil }
 
             self.notifier?.notify(WindowCreatedEvent(external: true, window: window))
+            self.collectCreatedWindow(windowDelegate)
             return windowDelegate
         }
     }
 
+    /// Adds a newly created window to the next WindowsCreatedEvent, if anyone is listening.
+    fileprivate func collectCreatedWindow(_ windowDelegate: WinDelegate) {
+        guard let notifier = notifier, notifier.hasHandlers(for: WindowsCreatedEvent.self) else {
+            return
+        }
+        pendingCreatedWindows.append(windowDelegate)
+        if pendingCreatedWindows.count == 1 {
+            DispatchQueue.main.asyncAfter(deadline: .now() + windowsCreatedInterval) { [weak self] in
+                guard let self = self else { return }
+                let batch = self.pendingCreatedWindows
+                self.pendingCreatedWindows = []
+                self.notifyWindowsCreated(batch)
+            }
+        }
+    }
+
+    /// Sends a WindowsCreatedEvent for `batch`, ordered the same as the `windows` attribute.
+    fileprivate func notifyWindowsCreated(_ batch: [WinDelegate]) {
+        Promise.value(()).map(on: .global()) { () -> [UIElement]? in
+            try traceRequest(self.axElement, "arrayAttribute", AXSwift.Attribute.windows,
+                             activity: self.activity) {
+                return try self.axElement.arrayAttribute(.windows)
+            }
+        }.recover { error -> Guarantee<[UIElement]?> in
+            // Fall back to the order in which the windows were created.
+            log.debug("Couldn't read window order of \(self): \(error)")
+            return .value(nil)
+        }.done { order in
+            let order = order ?? []
+            let live = batch.enumerated().filter { _, window in
+                window.isValid && self.windows.contains(where: { $0 === window })
+            }
+            // Windows missing from the list keep their creation order, after the others.
+            let positions = live.map { index, window in
+                (order.firstIndex(of: window.axElement) ?? order.count, index, window)
+            }
+            let sorted = positions.sorted { ($0.0, $0.1) < ($1.0, $1.1) }
+
+            let windows = sorted.compactMap { Window(delegate: $0.2) }
+            guard !windows.isEmpty, let application = Application(delegate: self) else { return }
+            self.notifier?.notify(
+                WindowsCreatedEvent(external: true, application: application, windows: windows)
+            )
+        }
+    }
+
     /// Does special handling for updating of properties that hold windows (mainWindow,
     /// focusedWindow).
     fileprivate func onWindowTypePropertyChanged(_ property: Property<OfOptionalType<Window>>,
@@ -420,11 +624,7 @@ extension OSXApplicationDelegate {
             windowDelegate.handleEvent(notification, observer: observer)
 
             if .uiElementDestroyed == notification {
-                // Remove window.
-                windows = windows.filter({ !$0.equalTo(windowDelegate) })
-
-                guard let window = Window(delegate: windowDelegate) else { return }
-                notifier?.notify(WindowDestroyedEvent(external: true, window: window))
+                removeWindow(windowDelegate)
             }
         }
 
@@ -444,9 +644,167 @@ extension OSXApplicationDelegate {
         }
     }
 
-    fileprivate func findWindowDelegateByElement(_ axElement: UIElement) -> WinDelegate? {
+    // Also used by FakeSwindler.
+    internal func findWindowDelegateByElement(_ axElement: UIElement) -> WinDelegate? {
         return windows.filter({ $0.axElement == axElement }).first
     }
+
+    /// Forgets a window that no longer exists and emits a WindowDestroyedEvent for it.
+    fileprivate func removeWindow(_ windowDelegate: WinDelegate) {
+        windows = windows.filter({ !$0.equalTo(windowDelegate) })
+        DependencyTracker.shared.changed(.collection(.windows))
+
+        defer { windowDelegate.extensions.removeAll() }
+        guard let window = Window(delegate: windowDelegate) else { return }
+        notifier?.notify(WindowDestroyedEvent(external: true, window: window))
+    }
+}
+
+/// Reaping of windows that became invalid, but whose destroyed notification never arrived.
+extension OSXApplicationDelegate {
+    func windowDidBecomeInvalid() {
+        // Give the destroyed notification a chance to arrive first.
+        scheduleReap(after: reapBackoff ?? reapDelay)
+    }
+
+    private func scheduleReap(after delay: TimeInterval) {
+        assert(Thread.current.isMainThread)
+        guard !isReapScheduled else { return }
+        isReapScheduled = true
+        DispatchQueue.main.asyncAfter(deadline: .now() + delay) { [weak self] in
+            guard let self = self else { return }
+            self.isReapScheduled = false
+            self.reapInvalidWindows()
+        }
+    }
+
+    /// Probes invalid windows by reading their role. Windows whose element is gone are removed and
+    /// reported destroyed; windows that answer are refreshed, and marked valid again if that
+    /// succeeds.
+    ///
+    /// At most `maximumReapProbes` windows are probed at once, and each probe is charged to the
+    /// polling IPC budget. Windows left over are probed in a later round. While probes go
+    /// unanswered or windows can't be refreshed, the delay between rounds doubles, up to
+    /// `maximumReapDelay`.
+    ///
+    /// - returns: The number of windows removed.
+    @discardableResult
+    func reapInvalidWindows() -> Guarantee<Int> {
+        assert(Thread.current.isMainThread)
+        // The round in progress schedules another if any windows are left.
+        guard !isReaping else { return .value(0) }
+        let invalid = windows.filter { !$0.isValid }
+        guard !invalid.isEmpty else { return .value(0) }
+
+        let budget = stateDelegate?.polling.ipcBudget
+        var candidates: [WinDelegate] = []
+        for window in invalid.prefix(maximumReapProbes) {
+            guard budget?.tryConsume(1) ?? true else { break }
+            candidates.append(window)
+        }
+        guard !candidates.isEmpty else {
+            log.debug("Postponing probes of invalid windows of \(self); over the IPC budget")
+            scheduleReap(after: reapDelay)
+            return .value(0)
+        }
+        isReaping = true
+
+        let probes = candidates.map { window in
+            Promise.value(()).map(on: .global()) { () -> Bool? in
+                do {
+                    let _: String? = try traceRequest(window.axElement, "attribute",
+                                                      AXSwift.Attribute.role,
+                                                      activity: self.activity) {
+                        try window.axElement.attribute(.role)
+                    }
+                    return true
+                } catch AXError.invalidUIElement {
+                    return false
+                } catch {
+                    return nil
+                }
+            }.recover { _ in .value(nil) }
+        }
+        return when(guarantees: probes).then { results -> Guarantee<Int> in
+            // Back on main thread.
+            var reaped = 0
+            var unanswered = false
+            var revalidations: [Guarantee<Bool>] = []
+            for (window, isAlive) in zip(candidates, results) {
+                // The window may have been destroyed while the probe was running.
+                guard self.windows.contains(where: { $0 === window }) else { continue }
+                switch isAlive {
+                case true?:
+                    log.debug("Window \(window) answered after becoming invalid; revalidating it")
+                    revalidations.append(window.revalidate())
+                case false?:
+                    self.removeWindow(window)
+                    reaped += 1
+                case nil:
+                    unanswered = true
+                }
+            }
+            if reaped > 0 {
+                log.info("Reaped \(reaped) invalid windows of \(self)")
+                self.reapedWindowCount += reaped
+            }
+            return when(guarantees: revalidations).map { revalidated in
+                self.isReaping = false
+                // A window that answers the probe but still can't be read counts as unanswered,
+                // so it is retried with backoff instead of every `reapDelay`.
+                if unanswered || revalidated.contains(false) {
+                    self.reapBackoff = min(self.maximumReapDelay,
+                                           (self.reapBackoff ?? self.reapDelay) * 2)
+                } else {
+                    self.reapBackoff = nil
+                }
+                if self.windows.contains(where: { !$0.isValid }) {
+                    self.scheduleReap(after: self.reapBackoff ?? self.reapDelay)
+                }
+                return reaped
+            }
+        }
+    }
+}
+
+/// Discovery of windows on spaces that weren't visible before.
+extension OSXApplicationDelegate {
+    func discoverWindows() -> Promise<(discovered: [WindowDelegate], listed: [WindowDelegate])> {
+        return Promise.value(()).map(on: .global()) { () -> [UIElement]? in
+            try traceRequest(self.axElement, "arrayAttribute", AXSwift.Attribute.windows,
+                             activity: self.activity) {
+                return try self.axElement.arrayAttribute(.windows)
+            }
+        }.then { maybeWindowElements -> Promise<(discovered: [WindowDelegate],
+                                                 listed: [WindowDelegate])> in
+            // Back on main thread.
+            let windowElements = maybeWindowElements ?? []
+            let listed: [WindowDelegate] =
+                windowElements.compactMap { self.findWindowDelegateByElement($0) }
+            let unknown = windowElements.filter { self.findWindowDelegateByElement($0) == nil }
+            let windowPromises = unknown.map { self.createWindowForElementIfNotExists($0) }
+            return successes(windowPromises, onError: { index, error in
+                log.debug("Couldn't initialize discovered window \(unknown[index]) of \(self): "
+                        + "\(error)")
+            }).map { windows in
+                let discovered: [WindowDelegate] = windows.compactMap { $0 }
+                return (discovered: discovered, listed: listed)
+            }
+        }
+    }
+}
+
+extension OSXApplicationDelegate: PollTarget {
+    var pollCost: Int {
+        return windows.count
+    }
+
+    func poll(qos: DispatchQoS.QoSClass) -> Promise<PollOutcome> {
+        let polls = windows.filter { $0.isValid }.map { $0.pollForChanges(qos: qos) }
+        return when(fulfilled: polls).map { outcomes in
+            outcomes.reduce(PollOutcome(), +)
+        }
+    }
 }
 
 extension OSXApplicationDelegate: PropertyNotifier {
@@ -456,9 +814,49 @@ extension OSXApplicationDelegate: PropertyNotifier {
                                           newValue: Event.PropertyType)
         where Event.Object == Application {
         guard let application = Application(delegate: self) else { return }
-        notifier?.notify(
+        let event =
             Event(external: external, object: application, oldValue: oldValue, newValue: newValue)
-        )
+        notifier?.notify(event)
+
+        // Window.isMain and Window.isFocused are derived from these, so their events follow.
+        switch event {
+        case let event as ApplicationMainWindowChangedEvent:
+            notifyWindowRoleChanged(WindowIsMainChangedEvent.self,
+                                    external: event.external,
+                                    from: event.oldValue,
+                                    to: event.newValue)
+        case let event as ApplicationFocusedWindowChangedEvent:
+            notifyWindowRoleChanged(WindowIsFocusedChangedEvent.self,
+                                    external: event.external,
+                                    from: event.oldValue,
+                                    to: event.newValue)
+        default:
+            break
+        }
+    }
+
+    /// Emits `Event` for the window that lost a role and the window that gained it. Only those two
+    /// windows are involved, however many windows the application has.
+    private func notifyWindowRoleChanged<Event: WindowPropertyEventType>(
+        _ event: Event.Type,
+        external: Bool,
+        from oldWindow: Window?,
+        to newWindow: Window?
+    ) where Event.Object == Window, Event.PropertyType == Bool {
+        guard oldWindow != newWindow else { return }
+        // A window that was destroyed doesn't need to hear that it lost its role.
+        if let oldWindow = oldWindow, oldWindow.isValid {
+            notifier?.notify(Event(external: external,
+                                   window: oldWindow,
+                                   oldValue: true,
+                                   newValue: false))
+        }
+        if let newWindow = newWindow {
+            notifier?.notify(Event(external: external,
+                                   window: newWindow,
+                                   oldValue: false,
+                                   newValue: true))
+        }
     }
 
     func notifyInvalid() {
@@ -469,16 +867,7 @@ extension OSXApplicationDelegate: PropertyNotifier {
 
 extension OSXApplicationDelegate: CustomStringConvertible {
     var description: String {
-        do {
-            let pid = try self.axElement.pid()
-            if let app = NSRunningApplication(processIdentifier: pid),
-               let bundle = app.bundleIdentifier {
-                return bundle
-            }
-            return "pid=\(pid)"
-        } catch {
-            return "Invalid"
-        }
+        return metadata.bundleIdentifier ?? "pid=\(processIdentifier!)"
     }
 }
 
@@ -488,10 +877,23 @@ extension OSXApplicationDelegate: CustomStringConvertible {
 private struct NewWindowHandler<UIElement: Equatable> {
     fileprivate var handlers: [HandlerType<UIElement>] = []
 
+    var count: Int { return handlers.count }
+
+    // A handler entry plus its closure context.
+    static var estimatedCostPerHandler: Int {
+        return MemoryLayout<HandlerType<UIElement>>.stride + 64
+    }
+
     mutating func performAfterWindowCreatedForElement(_ windowElement: UIElement,
                                                       handler: @escaping () -> Void) {
         assert(Thread.current.isMainThread)
         handlers.append(HandlerType(windowElement: windowElement, handler: handler))
+        MemoryBudget.shared.cacheDidGrow()
+    }
+
+    mutating func dropOldest(_ count: Int) {
+        assert(Thread.current.isMainThread)
+        handlers.removeFirst(count)
     }
 
     mutating func removeAllForUIElement(_ windowElement: UIElement) {
@@ -550,13 +952,16 @@ private final class MainWindowPropertyDelegate<
 
     let readDelegate: WindowPropertyAdapter<AXPropertyDelegate<UIElement, AppElement>,
                                             WinFinder, WinDelegate>
+    let activity: ProcessActivity
 
     init(_ appElement: AppElement,
          windowFinder: WinFinder,
          windowDelegate: WinDelegate.Type,
-         _ initPromise: Promise<[Attribute: Any]>) {
+         _ initPromise: Promise<[Attribute: Any]>,
+         activity: ProcessActivity) {
+        self.activity = activity
         readDelegate = WindowPropertyAdapter(
-            AXPropertyDelegate(appElement, .mainWindow, initPromise),
+            AXPropertyDelegate(appElement, .mainWindow, initPromise, activity: activity),
             windowFinder: windowFinder,
             windowDelegate: windowDelegate)
     }
@@ -586,7 +991,7 @@ private final class MainWindowPropertyDelegate<
         // To set the main window, we have to access the .main attribute of the window element and
         // set it to true.
         let writeDelegate = AXPropertyDelegate<Bool, UIElement>(
-            winDelegate.axElement, .main, Promise.value([:])
+            winDelegate.axElement, .main, Promise.value([:]), activity: activity
         )
         try writeDelegate.writeValue(true)
     }
@@ -640,14 +1045,8 @@ private final class WindowPropertyAdapter<
 
     fileprivate func findWindowByElement(_ element: Delegate.T) -> Window? {
         // Avoid using locks by forcing calls out to `windowFinder` to happen on the main thead.
-        var window: Window?
-        if Thread.current.isMainThread {
-            window = windowFinder?.findWindowByElement(element)
-        } else {
-            DispatchQueue.main.sync {
-                window = self.windowFinder?.findWindowByElement(element)
-            }
+        return syncOnMainThread("findWindowByElement") {
+            self.windowFinder?.findWindowByElement(element)
         }
-        return window
     }
 }
@@ -0,0 +1,118 @@
+import Cocoa
+
+// Borrowed views give access to Swindler objects without allocating a wrapper for each one. They
+// are handed to the visitor passed to `State.forEachWindow` and friends, and are only meant to be
+// used inside it. To keep an object around, materialize it with `window`, `application` or
+// `screen`.
+
+// MARK: - BorrowedWindow
+
+/// A window, borrowed for the duration of a `forEachWindow` call.
+public struct BorrowedWindow {
+    let delegate: WindowDelegate
+
+    /// Creates a `Window` that can be stored. This allocates.
+    ///
+    /// `nil` if the window's application has terminated.
+    public var window: Window? { return Window(delegate: delegate) }
+
+    /// See `Window.isValid`.
+    public var isValid: Bool { return delegate.isValid }
+
+    /// See `Window.frame`.
+    public var frame: WriteableProperty<OfType<CGRect>> { return delegate.frame }
+    /// See `Window.size`.
+    public var size: WriteableProperty<OfType<CGSize>> { return delegate.size }
+    /// See `Window.title`.
+    public var title: Property<OfDefaultedType<String>> { return delegate.title }
+    /// See `Window.isMinimized`.
+    public var isMinimized: WriteableProperty<OfType<Bool>> { return delegate.isMinimized }
+    /// See `Window.isFullscreen`.
+    public var isFullscreen: WriteableProperty<OfType<Bool>> { return delegate.isFullscreen }
+    /// See `Window.subrole`.
+    public var subrole: String? { return delegate.subrole }
+
+    /// See `Window.subscript(_:)`.
+    public subscript<Value>(key: ExtensionKey<Value>) -> Value? {
+        assert(Thread.current.isMainThread)
+        return delegate.extensions[key]
+    }
+}
+
+// MARK: - BorrowedApplication
+
+/// An application, borrowed for the duration of a `forEachApplication` call.
+public struct BorrowedApplication {
+    let delegate: ApplicationDelegate
+
+    /// Creates an `Application` that can be stored. This allocates.
+    public var application: Application? { return Application(delegate: delegate) }
+
+    public var processIdentifier: pid_t { return delegate.processIdentifier }
+    public var bundleIdentifier: String? { return delegate.metadata.bundleIdentifier }
+    public var localizedName: String? { return delegate.metadata.localizedName }
+
+    /// See `Application.isHidden`.
+    public var isHidden: WriteableProperty<OfType<Bool>> { return delegate.isHidden }
+
+    /// Calls `body` with each known window of the application, without allocating.
+    public func forEachWindow(_ body: (BorrowedWindow) throws -> Void) rethrows {
+        DependencyTracker.shared.recordRead(.collection(.windows))
+        try delegate.forEachWindowDelegate { try body(BorrowedWindow(delegate: $0)) }
+    }
+
+    /// See `Application.subscript(_:)`.
+    public subscript<Value>(key: ExtensionKey<Value>) -> Value? {
+        assert(Thread.current.isMainThread)
+        return delegate.extensions[key]
+    }
+}
+
+// MARK: - BorrowedScreen
+
+/// A screen, borrowed for the duration of a `forEachScreen` call.
+public struct BorrowedScreen {
+    let delegate: ScreenDelegate
+
+    /// Creates a `Screen` that can be stored. This allocates.
+    public var screen: Screen { return Screen(delegate: delegate) }
+
+    /// See `Screen.frame`.
+    public var frame: CGRect { return delegate.frame }
+    /// See `Screen.applicationFrame`.
+    public var applicationFrame: CGRect { return delegate.applicationFrame }
+}
+
+// MARK: - Visitors
+
+extension State {
+    /// Calls `body` with each known window, without allocating.
+    ///
+    /// Prefer this to `knownWindows` in code that runs often, like a render loop.
+    public func forEachWindow(_ body: (BorrowedWindow) throws -> Void) rethrows {
+        DependencyTracker.shared.recordRead(.collection(.windows))
+        try delegate.forEachWindowDelegate { try body(BorrowedWindow(delegate: $0)) }
+    }
+
+    /// Calls `body` with each running application, without allocating.
+    public func forEachApplication(_ body: (BorrowedApplication) throws -> Void) rethrows {
+        DependencyTracker.shared.recordRead(.collection(.applications))
+        try delegate.forEachApplicationDelegate { try body(BorrowedApplication(delegate: $0)) }
+    }
+
+    /// Calls `body` with each screen, without allocating.
+    public func forEachScreen(_ body: (BorrowedScreen) throws -> Void) rethrows {
+        DependencyTracker.shared.recordRead(.collection(.screens))
+        for screen in delegate.systemScreens.screens {
+            try body(BorrowedScreen(delegate: screen))
+        }
+    }
+}
+
+extension Application {
+    /// Calls `body` with each known window of the application, without allocating.
+    public func forEachWindow(_ body: (BorrowedWindow) throws -> Void) rethrows {
+        DependencyTracker.shared.recordRead(.collection(.windows))
+        try delegate.forEachWindowDelegate { try body(BorrowedWindow(delegate: $0)) }
+    }
+}
@@ -0,0 +1,209 @@
+import Foundation
+
+// MARK: - DerivedValue
+
+/// A value computed from Swindler properties and collections, which is kept up to date
+/// incrementally.
+///
+/// While `compute` runs, every `Property` value it reads is recorded, as are reads of the window,
+/// application and screen lists (`knownWindows`, `runningApplications`, `screens`). The value is
+/// only recomputed when one of those changes. Other `DerivedValue`s can be read from `compute`,
+/// too.
+///
+/// Changes are batched: any number of changes within one turn of the main run loop cause at most
+/// one recomputation, after which `onChange` handlers are called if the value changed. A value
+/// without handlers is recomputed lazily, the next time it is read.
+///
+/// ```swift
+/// let largestWindow = DerivedValue {
+///     state.knownWindows.max { $0.size.value.width < $1.size.value.width }
+/// }
+/// ```
+///
+/// - note: Derived values must only be created and read on the main thread.
+public final class DerivedValue<T> {
+    private let compute: () -> T
+    private let isEqual: ((T, T) -> Bool)?
+
+    private var cached: T!
+    private var isDirty = false
+    private var handlers: [(T) -> Void] = []
+    fileprivate var dependencies: Set<DependencyKey> = []
+
+    /// The number of times the value has been computed, for profiling.
+    public private(set) var recomputeCount: Int = 0
+
+    init(_ compute: @escaping () -> T, isEqual: ((T, T) -> Bool)?) {
+        self.compute = compute
+        self.isEqual = isEqual
+        recompute()
+    }
+
+    /// Creates a derived value. `onChange` handlers will be called every time the value is
+    /// recomputed.
+    public convenience init(_ compute: @escaping () -> T) {
+        self.init(compute, isEqual: nil)
+    }
+
+    deinit {
+        DependencyTracker.shared.removeDependencies(of: ObjectIdentifier(self), dependencies)
+    }
+
+    /// The current value, recomputing it first if any of its dependencies changed.
+    public var value: T {
+        assert(Thread.current.isMainThread)
+        DependencyTracker.shared.recordRead(.derived(ObjectIdentifier(self)))
+        if isDirty {
+            recompute()
+        }
+        return cached
+    }
+
+    /// Calls `handler` with the new value after the value changes. Changes are coalesced per run
+    /// loop turn.
+    public func onChange(_ handler: @escaping (T) -> Void) {
+        handlers.append(handler)
+    }
+
+    private func recompute() {
+        let tracker = DependencyTracker.shared
+        tracker.beginRecording()
+        let newValue = compute()
+        let newDependencies = tracker.endRecording()
+
+        tracker.updateDependencies(of: self, from: dependencies, to: newDependencies)
+        dependencies = newDependencies
+        cached = newValue
+        isDirty = false
+        recomputeCount += 1
+    }
+}
+
+extension DerivedValue where T: Equatable {
+    /// Creates a derived value. `onChange` handlers will only be called if the recomputed value is
+    /// different from the old one.
+    public convenience init(_ compute: @escaping () -> T) {
+        self.init(compute, isEqual: { $0 == $1 })
+    }
+}
+
+extension DerivedValue: Dependent {
+    func invalidate() {
+        guard !isDirty else { return }
+        isDirty = true
+        // Anything derived from us might change too.
+        DependencyTracker.shared.changed(.derived(ObjectIdentifier(self)))
+        if !handlers.isEmpty {
+            DependencyTracker.shared.scheduleFlush(self)
+        }
+    }
+
+    func flush() {
+        guard isDirty else { return }
+        let oldValue: T = cached
+        recompute()
+        if let isEqual = isEqual, isEqual(oldValue, cached) {
+            return
+        }
+        for handler in handlers {
+            handler(cached)
+        }
+    }
+}
+
+// MARK: - DependencyTracker
+
+/// The collections whose membership can be depended on.
+enum DependencyCollection {
+    case applications
+    case windows
+    case screens
+    case visibleWindows
+    case spaces
+}
+
+enum DependencyKey: Hashable {
+    case property(ObjectIdentifier)
+    case collection(DependencyCollection)
+    case derived(ObjectIdentifier)
+}
+
+protocol Dependent: AnyObject {
+    func invalidate()
+    func flush()
+}
+
+private struct WeakDependent {
+    weak var unbox: Dependent?
+}
+
+/// Records reads made while computing a `DerivedValue`, and invalidates derived values when the
+/// things they read change.
+///
+/// Everything here happens on the main thread. Reads from other threads are never recorded.
+final class DependencyTracker {
+    static let shared = DependencyTracker()
+
+    private var recording: [Set<DependencyKey>] = []
+    private var dependents: [DependencyKey: [ObjectIdentifier: WeakDependent]] = [:]
+    private var pending: [Dependent] = []
+
+    func recordRead(_ key: DependencyKey) {
+        // Checking the thread first avoids racing with the main thread on `recording`.
+        guard pthread_main_np() != 0, !recording.isEmpty else { return }
+        recording[recording.count - 1].insert(key)
+    }
+
+    func beginRecording() {
+        recording.append([])
+    }
+
+    func endRecording() -> Set<DependencyKey> {
+        return recording.removeLast()
+    }
+
+    func updateDependencies(of dependent: Dependent,
+                            from oldKeys: Set<DependencyKey>,
+                            to newKeys: Set<DependencyKey>) {
+        let id = ObjectIdentifier(dependent)
+        removeDependencies(of: id, oldKeys.subtracting(newKeys))
+        for key in newKeys.subtracting(oldKeys) {
+            dependents[key, default: [:]][id] = WeakDependent(unbox: dependent)
+        }
+    }
+
+    func removeDependencies(of id: ObjectIdentifier, _ keys: Set<DependencyKey>) {
+        for key in keys {
+            dependents[key]?.removeValue(forKey: id)
+            if dependents[key]?.isEmpty ?? false {
+                dependents.removeValue(forKey: key)
+            }
+        }
+    }
+
+    /// Called on the main thread when the value or membership identified by `key` changes.
+    func changed(_ key: DependencyKey) {
+        guard !dependents.isEmpty, let affected = dependents[key] else { return }
+        for entry in affected.values {
+            entry.unbox?.invalidate()
+        }
+    }
+
+    func scheduleFlush(_ dependent: Dependent) {
+        if pending.isEmpty {
+            DispatchQueue.main.async { self.flush() }
+        }
+        pending.append(dependent)
+    }
+
+    private func flush() {
+        // Handlers may cause further changes; keep going until everything has settled.
+        while !pending.isEmpty {
+            let batch = pending
+            pending = []
+            for dependent in batch {
+                dependent.flush()
+            }
+        }
+    }
+}
@@ -0,0 +1,170 @@
+import Cocoa
+
+/// Detects interactive move and resize gestures from the cadence of external frame changes.
+///
+/// While the user drags a window, the application sends a stream of `.moved` and `.resized`
+/// notifications, each of which turns into an external `WindowFrameChangedEvent`. Two external
+/// frame changes arriving within `dragCadence` of each other are treated as the start of a drag,
+/// and the drag ends once no external changes have been seen for `settleInterval` and the mouse
+/// button has been released.
+///
+/// Subscribers that only care about settled geometry can register with
+/// `EventNotifier.onSettledFrameChange`. They receive one `WindowFrameChangedEvent` per settled
+/// gesture, going from the frame before the gesture to the final frame. Settled changes are
+/// emitted as events, so they reach consumer notifiers like any other event.
+///
+/// Lives on the main thread, like `EventNotifier`.
+final class DragDetector {
+    /// Two external frame changes closer together than this are considered part of a drag.
+    var dragCadence: TimeInterval = 0.1
+    /// How long a window must go without external frame changes before it is considered settled.
+    var settleInterval: TimeInterval = 0.2
+
+    // Exposed for testing only.
+    var isMouseButtonDown: () -> Bool = { NSEvent.pressedMouseButtons != 0 }
+
+    private weak var notifier: EventNotifier?
+
+    /// Frame changes on a window that have not settled yet.
+    private final class Track {
+        var window: Window
+        let initialFrame: CGRect
+        var lastFrame: CGRect
+        var lastChange: TimeInterval
+        var kind: WindowDragKind?
+        var settleWork: DispatchWorkItem?
+
+        init(window: Window, initialFrame: CGRect, lastFrame: CGRect, at time: TimeInterval) {
+            self.window = window
+            self.initialFrame = initialFrame
+            self.lastFrame = lastFrame
+            self.lastChange = time
+        }
+    }
+    private var tracks: [ObjectIdentifier: Track] = [:]
+
+    init(notifier: EventNotifier) {
+        self.notifier = notifier
+        notifier.on(label: "DragDetector") { [weak self] (event: WindowFrameChangedEvent) in
+            self?.frameChanged(event)
+        }
+        notifier.on(label: "DragDetector") { [weak self] (event: WindowDestroyedEvent) in
+            self?.windowDestroyed(event.window)
+        }
+    }
+
+    /// Tracking is only done if somebody is listening for its results.
+    private var isActive: Bool {
+        guard let notifier = notifier else { return false }
+        return notifier.hasHandlers(for: FrameSettledEvent.self)
+            || notifier.hasHandlers(for: WindowDragBeganEvent.self)
+            || notifier.hasHandlers(for: WindowDragEndedEvent.self)
+    }
+
+    private func frameChanged(_ event: WindowFrameChangedEvent) {
+        assert(Thread.current.isMainThread)
+        let key = ObjectIdentifier(event.window.delegate)
+
+        guard let track = tracks[key] else {
+            if !event.external {
+                // Changes caused by Swindler settle immediately.
+                notifySettled(event)
+            } else if isActive {
+                let track = Track(window: event.window,
+                                  initialFrame: event.oldValue,
+                                  lastFrame: event.newValue,
+                                  at: ProcessInfo.processInfo.systemUptime)
+                tracks[key] = track
+                scheduleSettle(track, key: key)
+            }
+            return
+        }
+
+        // Internal changes during a gesture (for example, snapping the window as it moves) are
+        // folded into the gesture, but don't count towards its cadence.
+        track.window = event.window
+        track.lastFrame = event.newValue
+        guard event.external else { return }
+
+        let now = ProcessInfo.processInfo.systemUptime
+        let interval = now - track.lastChange
+        track.lastChange = now
+
+        let resized = event.oldValue.size != event.newValue.size
+        if track.kind == nil {
+            if interval <= dragCadence {
+                let kind: WindowDragKind =
+                    (resized || track.initialFrame.size != event.newValue.size) ? .resize : .move
+                track.kind = kind
+                notifier?.notify(WindowDragBeganEvent(external: true,
+                                                      window: event.window,
+                                                      kind: kind,
+                                                      initialFrame: track.initialFrame))
+            }
+        } else if resized {
+            track.kind = .resize
+        }
+        scheduleSettle(track, key: key)
+    }
+
+    private func scheduleSettle(_ track: Track, key: ObjectIdentifier) {
+        track.settleWork?.cancel()
+        let work = DispatchWorkItem { [weak self] in
+            self?.settle(key)
+        }
+        track.settleWork = work
+        DispatchQueue.main.asyncAfter(deadline: .now() + settleInterval, execute: work)
+    }
+
+    private func settle(_ key: ObjectIdentifier) {
+        guard let track = tracks[key] else { return }
+        if track.kind != nil && isMouseButtonDown() {
+            // The user is still holding the window, but has stopped moving the mouse.
+            scheduleSettle(track, key: key)
+            return
+        }
+        tracks.removeValue(forKey: key)
+
+        if let kind = track.kind {
+            notifier?.notify(WindowDragEndedEvent(external: true,
+                                                  window: track.window,
+                                                  kind: kind,
+                                                  initialFrame: track.initialFrame,
+                                                  finalFrame: track.lastFrame))
+        }
+        if track.initialFrame != track.lastFrame {
+            notifySettled(WindowFrameChangedEvent(external: true,
+                                                  window: track.window,
+                                                  oldValue: track.initialFrame,
+                                                  newValue: track.lastFrame))
+        }
+    }
+
+    private func windowDestroyed(_ window: Window) {
+        guard let track = tracks.removeValue(forKey: ObjectIdentifier(window.delegate)) else {
+            return
+        }
+        track.settleWork?.cancel()
+    }
+
+    private func notifySettled(_ event: WindowFrameChangedEvent) {
+        guard let notifier = notifier, notifier.hasHandlers(for: FrameSettledEvent.self) else {
+            return
+        }
+        notifier.notify(FrameSettledEvent(external: event.external, change: event))
+    }
+}
+
+/// Emitted by `DragDetector` when the frame of a window settles.
+struct FrameSettledEvent: EventType {
+    let external: Bool
+    let change: WindowFrameChangedEvent
+}
+
+extension EventNotifier {
+    /// Calls `handler` with the frame change when the frame of a window settles. See
+    /// `DragDetector`.
+    func onSettledFrameChange(_ handler: @escaping (WindowFrameChangedEvent) -> Void) {
+        on { (event: FrameSettledEvent) in handler(event.change) }
+    }
+}
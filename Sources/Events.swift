@@ -65,11 +65,34 @@ public struct WindowCreatedEvent: EventType {
     public let window: Window
 }
 
+/// Windows of an application that were created in quick succession, delivered together.
+///
+/// This is sent in addition to the `WindowCreatedEvent` for each window, shortly after them. It is
+/// useful when an application creates many windows at once (for instance, when restoring its
+/// session) and you only want to react once. The windows are ordered as in the application's own
+/// window list, front to back.
+///
+/// Only collected if there is a handler for this event.
+public struct WindowsCreatedEvent: EventType {
+    public let external: Bool
+    public let application: Application
+    public let windows: [Window]
+}
+
 public struct WindowDestroyedEvent: EventType {
     public let external: Bool
     public let window: Window
 }
 
+/// Emitted when Swindler finds a window that already existed, on a space it hasn't seen before.
+///
+/// Windows on spaces Swindler hasn't seen aren't known until the user visits the space. Unlike a
+/// `WindowCreatedEvent`, this doesn't mean the window was just created.
+public struct WindowDiscoveredEvent: EventType {
+    public let external: Bool
+    public let window: Window
+}
+
 protocol WindowPropertyEventType: PropertyEventType {
     associatedtype Object = Window
     init(external: Bool, window: Object, oldValue: PropertyType, newValue: PropertyType)
@@ -107,6 +130,32 @@ public struct WindowMinimizedChangedEvent: WindowPropertyEventType {
     public let newValue: PropertyType
 }
 
+/// Emitted when a window becomes or stops being the main window of its application.
+///
+/// Follows the `ApplicationMainWindowChangedEvent` it is derived from, for the old and the new main
+/// window.
+public struct WindowIsMainChangedEvent: WindowPropertyEventType {
+    public typealias Object = Window
+    public typealias PropertyType = Bool
+    public let external: Bool
+    public let window: Window
+    public let oldValue: PropertyType
+    public let newValue: PropertyType
+}
+
+/// Emitted when a window becomes or stops being the focused window of its application.
+///
+/// Follows the `ApplicationFocusedWindowChangedEvent` it is derived from, for the old and the new
+/// focused window.
+public struct WindowIsFocusedChangedEvent: WindowPropertyEventType {
+    public typealias Object = Window
+    public typealias PropertyType = Bool
+    public let external: Bool
+    public let window: Window
+    public let oldValue: PropertyType
+    public let newValue: PropertyType
+}
+
 protocol ApplicationPropertyEventType: PropertyEventType {
     associatedtype Object = Application
     init(external: Bool, application: Object, oldValue: PropertyType, newValue: PropertyType)
@@ -144,6 +193,27 @@ public struct ApplicationFocusedWindowChangedEvent: ApplicationPropertyEventType
     public let newValue: PropertyType
 }
 
+/// Emitted once per user focus switch, after the frontmost application and its main and focused
+/// windows have all settled.
+///
+/// This summarizes the `FrontmostApplicationChangedEvent`, `ApplicationMainWindowChangedEvent` and
+/// `ApplicationFocusedWindowChangedEvent` that make up a switch, which arrive in no particular
+/// order. Those events are still delivered; this one follows them shortly after.
+public struct FocusChangedEvent: EventType {
+    public let external: Bool
+    /// The frontmost application before the switch.
+    public let oldApplication: Application?
+    /// The frontmost application after the switch.
+    public let newApplication: Application?
+    /// The window with keyboard focus before the switch.
+    public let oldWindow: Window?
+    /// The window with keyboard focus after the switch. This is the focused window of
+    /// `newApplication`, which may be a panel or sheet rather than its main window.
+    public let newWindow: Window?
+    /// The time between the first and last change making up the switch, in seconds.
+    public let latency: TimeInterval
+}
+
 public struct ScreenLayoutChangedEvent: EventType {
     public let external: Bool
     public let addedScreens: [Screen]
@@ -152,3 +222,51 @@ public struct ScreenLayoutChangedEvent: EventType {
     public let changedScreens: [Screen]
     public let unchangedScreens: [Screen]
 }
+
+/// Emitted when the space visible on a screen changes.
+///
+/// If the new space hasn't been seen before, `windowsGained` is empty; windows found on it are
+/// reported afterwards with a `WindowDiscoveredEvent` each.
+public struct SpaceChangedEvent: EventType {
+    public let external: Bool
+    public let screen: Screen
+    /// The space that was visible on `screen`, or nil if the screen was just added.
+    public let oldValue: Space?
+    public let newValue: Space
+    /// The known windows of `oldValue`, which are no longer visible.
+    public let windowsLost: [Window]
+    /// The known windows of `newValue`, which are now visible.
+    public let windowsGained: [Window]
+}
+
+/// The kind of interactive gesture being performed on a window.
+public enum WindowDragKind {
+    /// The window is being moved without changing its size.
+    case move
+    /// The window is being resized (possibly also moving its origin).
+    case resize
+}
+
+/// Emitted when Swindler detects that a window is being interactively moved or resized.
+///
+/// Detection is based on the cadence of external frame changes, so by the time this event is
+/// emitted, the first `WindowFrameChangedEvent` of the gesture has already been delivered.
+public struct WindowDragBeganEvent: EventType {
+    public let external: Bool
+    public let window: Window
+    public let kind: WindowDragKind
+    /// The frame of the window before the gesture began.
+    public let initialFrame: CGRect
+}
+
+/// Emitted once a window that was being interactively moved or resized has settled.
+public struct WindowDragEndedEvent: EventType {
+    public let external: Bool
+    public let window: Window
+    /// The kind of gesture. If the window was resized at any point, this is `.resize`.
+    public let kind: WindowDragKind
+    /// The frame of the window before the gesture began.
+    public let initialFrame: CGRect
+    /// The frame of the window once the gesture ended.
+    public let finalFrame: CGRect
+}
@@ -0,0 +1,92 @@
+import Foundation
+
+/// A key for attaching your own data to a `Window` or `Application`.
+///
+/// Keys are compared by identity, so create each key once (for example as a static constant).
+/// Objects keep the keys of the values stored on them alive, so a key is never confused with a
+/// later one.
+///
+/// ```swift
+/// let tilingSlot = ExtensionKey<Int>()
+/// window[tilingSlot] = 3
+/// ```
+public final class ExtensionKey<Value> {
+    public init() {}
+}
+
+/// Typed per-object storage, keyed by `ExtensionKey`.
+///
+/// Stored on the object's delegate, so it is shared by every wrapper of the same object and lives
+/// exactly as long as the object does. Lookups are O(1).
+struct ExtensionStorage {
+    // Each entry retains its key, so the identifier can't be reused by another key while the
+    // entry exists.
+    private var values: [ObjectIdentifier: (key: AnyObject, value: Any)] = [:]
+
+    subscript<Value>(key: ExtensionKey<Value>) -> Value? {
+        get {
+            return values[ObjectIdentifier(key)]?.value as? Value
+        }
+        set {
+            values[ObjectIdentifier(key)] = newValue.map { (key, $0) }
+        }
+    }
+
+    mutating func removeAll() {
+        values.removeAll()
+    }
+}
+
+/// Removes the values stored under `key` from the windows of `state`, for owners of a per-instance
+/// key that go away before the windows do.
+func removeExtension<Value>(_ key: ExtensionKey<Value>, fromWindowsOf state: State?) {
+    guard let state = state else { return }
+    let remove = {
+        for window in state.knownWindows {
+            window[key] = nil
+        }
+    }
+    if Thread.current.isMainThread {
+        remove()
+    } else {
+        DispatchQueue.main.async(execute: remove)
+    }
+}
+
+extension Window {
+    /// Data you have attached to this window.
+    ///
+    /// The data is released when the window is destroyed, after `WindowDestroyedEvent` handlers
+    /// have run.
+    ///
+    /// - note: Must only be used on the main thread.
+    public subscript<Value>(key: ExtensionKey<Value>) -> Value? {
+        get {
+            assert(Thread.current.isMainThread)
+            return delegate.extensions[key]
+        }
+        set {
+            assert(Thread.current.isMainThread)
+            delegate.extensions[key] = newValue
+        }
+    }
+}
+
+extension Application {
+    /// Data you have attached to this application.
+    ///
+    /// The data is released when the application terminates, after
+    /// `ApplicationTerminatedEvent` handlers have run.
+    ///
+    /// - note: Must only be used on the main thread.
+    public subscript<Value>(key: ExtensionKey<Value>) -> Value? {
+        get {
+            assert(Thread.current.isMainThread)
+            return delegate.extensions[key]
+        }
+        set {
+            assert(Thread.current.isMainThread)
+            delegate.extensions[key] = newValue
+        }
+    }
+}
@@ -328,8 +328,13 @@ class FakeObserver: ObserverType {
     var lock: NSLock = NSLock()
     var watchedElements: [TestUIElement: [AXNotification]] = [:]
 
+    /// The run loop callbacks are delivered on. An observer created on an `ObserverThread` emits
+    /// on that thread without waiting, like AXObserver; otherwise it emits on the main thread.
+    let runLoop: CFRunLoop
+
     required init(processID: pid_t, callback: @escaping Callback) throws {
         self.callback = callback
+        runLoop = Thread.current is ObserverThread ? CFRunLoopGetCurrent() : CFRunLoopGetMain()
     }
 
     func addNotification(_ notification: AXNotification, forElement element: TestUIElement) throws {
@@ -372,10 +377,16 @@ class FakeObserver: ObserverType {
                 watchedElement: TestUIElement,
                 passedElement: TestUIElement) {
         let watched = watchedElements[watchedElement] ?? []
-        if watched.contains(notification) {
-            performOnMainThread {
+        guard watched.contains(notification) else { return }
+        if runLoop === CFRunLoopGetMain() {
+            syncOnMainThread("FakeObserver.emit") {
                 callback(self, passedElement, notification)
             }
+        } else {
+            CFRunLoopPerformBlock(runLoop, CFRunLoopMode.defaultMode.rawValue) {
+                self.callback(self, passedElement, notification)
+            }
+            CFRunLoopWakeUp(runLoop)
         }
     }
 }
@@ -404,6 +415,16 @@ class FakeApplicationObserver: ApplicationObserverType {
         setFrontmost(pid)
     }
 
+    func metadata(forProcessID processID: pid_t) -> ApplicationMetadata {
+        guard let app = appElement(forProcessID: processID)?.companion as? FakeApplication else {
+            return ApplicationMetadata()
+        }
+        return ApplicationMetadata(bundleIdentifier: app.bundleId,
+                                   localizedName: app.localizedName,
+                                   activationPolicy: .regular,
+                                   launchDate: nil)
+    }
+
     typealias ApplicationElement = EmittingTestApplicationElement
     var allApps: [ApplicationElement] = []
     func allApplications() -> [EmittingTestApplicationElement] {
@@ -427,20 +448,34 @@ extension FakeApplicationObserver {
     }
 }
 
+class FakeSpaceObserver: SpaceObserver {
+    private(set) var spaceIDs: [Int]
+
+    /// - parameter spaceIDs: The ID of the space initially visible on each screen.
+    init(spaceIDs: [Int] = [1]) {
+        self.spaceIDs = spaceIDs
+    }
+
+    func currentSpaceIDs() -> [Int] {
+        return spaceIDs
+    }
+
+    private var handlers: [([Int]) -> Void] = []
+    func onSpaceChanged(_ handler: @escaping ([Int]) -> Void) {
+        handlers.append(handler)
+    }
+}
+
+extension FakeSpaceObserver {
+    func switchSpaces(to spaceIDs: [Int]) {
+        self.spaceIDs = spaceIDs
+        handlers.forEach { $0(spaceIDs) }
+    }
+}
+
 final private class WeakBox<A: AnyObject> {
     weak var unbox: A?
     init(_ value: A) {
         unbox = value
     }
 }
-
-/// Performs the given action on the main thread, synchronously, regardless of the current thread.
-private func performOnMainThread(_ action: () -> Void) {
-    if Thread.current.isMainThread {
-        action()
-    } else {
-        DispatchQueue.main.sync {
-            action()
-        }
-    }
-}
@@ -19,13 +19,20 @@ public class FakeState {
     fileprivate typealias Delegate =
         OSXStateDelegate<TestUIElement, AppElement, FakeObserver, FakeApplicationObserver>
 
-    public static func initialize(screens: [FakeScreen] = [FakeScreen()]) -> Promise<FakeState> {
+    public static func initialize(
+        screens: [FakeScreen] = [FakeScreen()],
+        configuration: Configuration = Configuration()
+    ) -> Promise<FakeState> {
         let appObserver = FakeApplicationObserver()
+        let spaceObserver = FakeSpaceObserver(spaceIDs: screens.indices.map { $0 + 1 })
         let screens = FakeSystemScreenDelegate(screens: screens.map{ $0.delegate })
         return firstly {
-            Delegate.initialize(appObserver: appObserver, screens: screens)
+            Delegate.initialize(appObserver: appObserver,
+                                screens: screens,
+                                spaces: spaceObserver,
+                                configuration: configuration)
         }.map { delegate in
-            FakeState(delegate, appObserver)
+            FakeState(delegate, appObserver, spaceObserver)
         }
     }
 
@@ -44,13 +51,41 @@ public class FakeState {
         }
     }
 
+    /// The ID of the space visible on each screen, in the order of `state.screens`. The screens
+    /// start out on spaces 1, 2, and so on.
+    ///
+    /// Setting this simulates the user switching spaces. As with the accessibility API, windows on
+    /// spaces that aren't visible are left out of their application's window list.
+    public var currentSpaceIDs: [Int] {
+        get { return spaceObserver.spaceIDs }
+        set {
+            let visibleSpaces = Set(newValue)
+            for appElement in appObserver.allApps {
+                (appElement.companion as? FakeApplication)?.updateWindowList(visibleSpaces)
+            }
+            spaceObserver.switchSpaces(to: newValue)
+        }
+    }
+
     fileprivate var delegate: Delegate
     var appObserver: FakeApplicationObserver
+    var spaceObserver: FakeSpaceObserver
 
-    private init(_ delegate: Delegate, _ appObserver: FakeApplicationObserver) {
+    private init(_ delegate: Delegate,
+                 _ appObserver: FakeApplicationObserver,
+                 _ spaceObserver: FakeSpaceObserver) {
         self.state = State(delegate: delegate)
         self.delegate = delegate
         self.appObserver = appObserver
+        self.spaceObserver = spaceObserver
+    }
+
+    /// The ID of the space visible on the screen that most of `frame` is on.
+    fileprivate func visibleSpaceID(containing frame: CGRect) -> Int? {
+        let spaceIDs = currentSpaceIDs
+        let screens = delegate.systemScreens.screens
+        let index = indexOfScreen(containingMostOf: frame, in: screens) ?? 0
+        return index < spaceIDs.count ? spaceIDs[index] : spaceIDs.first
     }
 }
 
@@ -69,6 +104,10 @@ public struct FakeApplicationBuilder {
         app.bundleId = bundleId
         return self
     }
+    public func setLocalizedName(_ name: String?) -> FakeApplicationBuilder {
+        app.localizedName = name
+        return self
+    }
     public func setHidden(_ hidden: Bool) -> FakeApplicationBuilder {
         app.isHidden = hidden
         return self
@@ -94,6 +133,7 @@ public class FakeApplication {
 
     fileprivate(set) var processId: pid_t
     fileprivate(set) var bundleId: String?
+    fileprivate(set) var localizedName: String?
 
     public var isHidden: Bool {
         get { return try! element.attribute(.hidden)! }
@@ -128,6 +168,9 @@ public class FakeApplication {
 
     fileprivate var delegate: Delegate!
 
+    // Every window of the application, front to back, with the space it is on.
+    fileprivate var windowSpaces: [(element: EmittingTestWindowElement, spaceID: Int?)] = []
+
     fileprivate init(parent: FakeState) {
         self.parent = parent
         element = AppElement()
@@ -141,6 +184,12 @@ public class FakeApplication {
     public func createWindow() -> FakeWindowBuilder {
         return FakeWindowBuilder(parent: self)
     }
+
+    fileprivate func updateWindowList(_ visibleSpaces: Set<Int>) {
+        element.windows = windowSpaces.filter { _, spaceID in
+            spaceID.map { visibleSpaces.contains($0) } ?? true
+        }.map { $0.element }
+    }
 }
 
 public func ==(lhs: FakeApplication, rhs: FakeApplication) -> Bool {
@@ -168,10 +217,31 @@ public class FakeWindowBuilder {
         w.isFullscreen = isFullscreen
         return self
     }
+    /// Puts the window on the space with the given ID, instead of the one visible on its screen.
+    /// If that space isn't visible, Swindler doesn't know about the window until it is.
+    public func setSpace(_ spaceID: Int) -> FakeWindowBuilder {
+        w.spaceID = spaceID
+        return self
+    }
+    public func setOnAllSpaces() -> FakeWindowBuilder {
+        w.isOnAllSpaces = true
+        return self
+    }
 
     public func build() -> Promise<FakeWindow> {
         // TODO schedule new window event
         //w.parent.delegate!...
+        let state = w.parent.parent
+        let spaceID = w.isOnAllSpaces ? nil : w.spaceID ?? state.visibleSpaceID(containing: w.frame)
+        w.spaceID = spaceID
+        w.parent.windowSpaces.insert((w.element, spaceID), at: 0)
+        if let spaceID = spaceID, !state.currentSpaceIDs.contains(spaceID) {
+            // Swindler finds the window once its space is visible.
+            return .value(w)
+        }
+
+        // New windows appear at the front of the application's window list.
+        w.parent.element.windows.insert(w.element, at: 0)
         return w.parent.delegate.addWindowElement(w.element).map { delegate in
             self.w.delegate = delegate
             return self.w
@@ -184,9 +254,19 @@ public class FakeWindow: TestObject {
 
     public let parent: FakeApplication
     public var window: Window {
-        get { return Window(delegate: delegate!)! }
+        get {
+            if delegate == nil {
+                // Windows on spaces that weren't visible when they were built are found later.
+                delegate = parent.delegate.findWindowDelegateByElement(element)
+            }
+            return Window(delegate: delegate!)!
+        }
     }
 
+    /// The ID of the space the window is on. `nil` if it is on all spaces.
+    public fileprivate(set) var spaceID: Int?
+    fileprivate var isOnAllSpaces = false
+
     let element: EmittingTestWindowElement
 
     public var title: String {
@@ -0,0 +1,86 @@
+import Cocoa
+
+/// Turns the events making up a focus switch into a single `FocusChangedEvent`.
+///
+/// When the user switches to another window, Swindler sees a `FrontmostApplicationChangedEvent`,
+/// an `ApplicationMainWindowChangedEvent` and an `ApplicationFocusedWindowChangedEvent`, in no
+/// particular order and possibly spread over several run loop turns. Each of them starts or extends
+/// a transition, which settles once none have arrived for `settleInterval`. The focus is then read
+/// once, and an event is emitted if it differs from the focus before the transition.
+///
+/// Lives on the main thread, like `EventNotifier`.
+final class FocusTracker {
+    /// How long to wait after the last component event before the transition is considered
+    /// settled.
+    var settleInterval: TimeInterval = 0.05
+
+    /// The focus as of the last settled transition.
+    private var focus: (application: Application?, window: Window?)
+
+    private weak var notifier: EventNotifier?
+    private let currentFocus: () -> (application: Application?, window: Window?)
+
+    private var transitionStart: TimeInterval?
+    private var lastChange: TimeInterval = 0
+    private var settleWork: DispatchWorkItem?
+
+    /// - parameter currentFocus: Reads the frontmost application and its focused window.
+    init(notifier: EventNotifier,
+         currentFocus: @escaping () -> (application: Application?, window: Window?)) {
+        self.notifier = notifier
+        self.currentFocus = currentFocus
+        focus = (nil, nil)
+
+        notifier.on(label: "FocusTracker") { [weak self] (_: FrontmostApplicationChangedEvent) in
+            self?.componentChanged()
+        }
+        notifier.on(label: "FocusTracker") { [weak self] (_: ApplicationMainWindowChangedEvent) in
+            self?.componentChanged()
+        }
+        notifier.on(label: "FocusTracker") {
+            [weak self] (_: ApplicationFocusedWindowChangedEvent) in
+            self?.componentChanged()
+        }
+    }
+
+    /// Records the focus that the first transition starts from. Call once the state is initialized.
+    func start() {
+        focus = currentFocus()
+    }
+
+    private func componentChanged() {
+        assert(Thread.current.isMainThread)
+        let now = ProcessInfo.processInfo.systemUptime
+        if transitionStart == nil {
+            transitionStart = now
+        }
+        lastChange = now
+
+        settleWork?.cancel()
+        let work = DispatchWorkItem { [weak self] in
+            self?.settle()
+        }
+        settleWork = work
+        DispatchQueue.main.asyncAfter(deadline: .now() + settleInterval, execute: work)
+    }
+
+    private func settle() {
+        guard let start = transitionStart else { return }
+        transitionStart = nil
+        settleWork = nil
+
+        let old = focus
+        let new = currentFocus()
+        focus = new
+        guard old.application != new.application || old.window != new.window else { return }
+
+        let latency = lastChange - start
+        Metrics.shared.recordFocusTransition(latency: latency)
+        notifier?.notify(FocusChangedEvent(external: true,
+                                           oldApplication: old.application,
+                                           newApplication: new.application,
+                                           oldWindow: old.window,
+                                           newWindow: new.window,
+                                           latency: latency))
+    }
+}
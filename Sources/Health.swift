@@ -0,0 +1,249 @@
+import Cocoa
+
+// MARK: - Health
+
+/// A snapshot of Swindler's internal state, for diagnosing a misbehaving app without a debugger.
+///
+/// Collecting one takes a few locks and no accessibility calls, so it is cheap enough to poll every
+/// second.
+public struct Health: CustomStringConvertible {
+    /// The time the snapshot was taken.
+    public let date: Date
+    /// One entry per running application, in no particular order.
+    public let applications: [ApplicationHealth]
+    /// Utilization of the background threads Swindler makes requests on.
+    public let threadPool: ThreadPoolHealth
+
+    public var description: String {
+        var lines = ["\(threadPool)"]
+        lines += applications.map { "  \($0)" }
+        return lines.joined(separator: "\n")
+    }
+}
+
+/// The state of Swindler's communication with a single application.
+public struct ApplicationHealth: CustomStringConvertible {
+    public let processIdentifier: pid_t
+    public let bundleIdentifier: String?
+
+    /// Accessibility requests to the application that are executing right now.
+    public let inFlightRequests: Int
+    /// Property reads and writes waiting for a thread, or for an earlier request on the same
+    /// property to finish.
+    public let queuedRequests: Int
+    /// Property refreshes whose result hasn't been delivered yet. Includes queued and in-flight
+    /// ones.
+    public let pendingRefreshes: Int
+    /// Actions waiting for a window the application announced to finish initializing.
+    public let deferredWindowHandlers: Int
+    /// Windows removed because they stopped responding, without the application announcing that
+    /// they were destroyed.
+    public let reapedWindows: Int
+
+    /// The time the application last answered an accessibility request successfully, if ever.
+    public let lastResponseDate: Date?
+    /// The most recent accessibility error from the application, if any.
+    public let lastError: String?
+    /// The time of `lastError`.
+    public let lastErrorDate: Date?
+
+    /// How long ago the application last answered an accessibility request successfully.
+    public var timeSinceLastResponse: TimeInterval? {
+        return lastResponseDate.map { Date().timeIntervalSince($0) }
+    }
+
+    public var description: String {
+        var parts = ["\(bundleIdentifier ?? "?") (pid=\(processIdentifier))",
+                     "inFlight=\(inFlightRequests)",
+                     "queued=\(queuedRequests)",
+                     "refreshes=\(pendingRefreshes)",
+                     "deferred=\(deferredWindowHandlers)",
+                     "reaped=\(reapedWindows)"]
+        if let elapsed = timeSinceLastResponse {
+            parts.append("lastResponse=\(Int(elapsed * 1000))ms ago")
+        }
+        if let error = lastError {
+            parts.append("lastError=\(error)")
+        }
+        return parts.joined(separator: " ")
+    }
+}
+
+/// Utilization of the threads Swindler makes blocking requests on.
+///
+/// Requests are made on the global concurrent dispatch queue, which doesn't report its own
+/// utilization, so this is measured from Swindler's side: a request is active while it is
+/// executing on one of the queue's threads.
+public struct ThreadPoolHealth: CustomStringConvertible {
+    /// Requests executing on a background thread right now, across all applications.
+    public let activeRequests: Int
+    /// Requests waiting to start, across all applications.
+    public let queuedRequests: Int
+    /// The number of processors, which bounds how many requests the queue runs without
+    /// overcommitting.
+    public let processorCount: Int
+    /// Background threads blocked on the main thread right now (see `StallReport`). Only counted
+    /// while the stall watchdog is running.
+    public let pendingSyncHops: Int
+
+    /// `activeRequests` as a fraction of `processorCount`. Can exceed 1, because the queue starts
+    /// extra threads when requests block.
+    public var utilization: Double {
+        return Double(activeRequests) / Double(max(processorCount, 1))
+    }
+
+    public var description: String {
+        return "threads: active=\(activeRequests) queued=\(queuedRequests) "
+             + "cpus=\(processorCount) syncHops=\(pendingSyncHops)"
+    }
+}
+
+extension State {
+    /// Returns a snapshot of Swindler's internal state.
+    ///
+    /// - note: Must be called on the main thread.
+    public func health() -> Health {
+        assert(Thread.current.isMainThread)
+        var applications: [ApplicationHealth] = []
+        delegate.forEachApplicationDelegate { applications.append($0.health) }
+        let threadPool = ThreadPoolHealth(
+            activeRequests: applications.reduce(0) { $0 + $1.inFlightRequests },
+            queuedRequests: applications.reduce(0) { $0 + $1.queuedRequests },
+            processorCount: ProcessInfo.processInfo.activeProcessorCount,
+            pendingSyncHops: Metrics.shared.activity.pendingSyncHopCount
+        )
+        return Health(date: Date(), applications: applications, threadPool: threadPool)
+    }
+}
+
+// MARK: - ProcessActivity
+
+/// Counts the requests Swindler makes to one process. Safe to use from any thread.
+///
+/// Each application delegate owns one, and hands it down to its windows and properties so that
+/// requests can be counted without looking anything up.
+final class ProcessActivity {
+    private let lock = NSLock()
+    private var inFlightRequests = 0
+    private var queuedRequests = 0
+    private var pendingRefreshes = 0
+    private var lastResponseDate: Date?
+    private var lastError: String?
+    private var lastErrorDate: Date?
+
+    func requestBegan() {
+        lock.lock()
+        defer { lock.unlock() }
+        inFlightRequests += 1
+    }
+
+    func requestEnded(error: Error?) {
+        lock.lock()
+        defer { lock.unlock() }
+        inFlightRequests -= 1
+        if let error = error {
+            lastError = String(describing: error)
+            lastErrorDate = Date()
+        } else {
+            lastResponseDate = Date()
+        }
+    }
+
+    /// Called when a property read or write is issued. Returns the request, to be marked as
+    /// dequeued when it starts executing and completed when it is done.
+    func queued(refresh: Bool) -> QueuedRequest {
+        lock.lock()
+        defer { lock.unlock() }
+        queuedRequests += 1
+        if refresh {
+            pendingRefreshes += 1
+        }
+        return QueuedRequest(activity: self, refresh: refresh)
+    }
+
+    fileprivate func dequeued(_ request: QueuedRequest) {
+        lock.lock()
+        defer { lock.unlock() }
+        guard !request.started else { return }
+        request.started = true
+        queuedRequests -= 1
+    }
+
+    fileprivate func completed(_ request: QueuedRequest) {
+        lock.lock()
+        defer { lock.unlock() }
+        if !request.started {
+            request.started = true
+            queuedRequests -= 1
+        }
+        if request.refresh {
+            pendingRefreshes -= 1
+        }
+    }
+
+    func health(processIdentifier: pid_t,
+                bundleIdentifier: String?,
+                deferredWindowHandlers: Int,
+                reapedWindows: Int) -> ApplicationHealth {
+        lock.lock()
+        defer { lock.unlock() }
+        return ApplicationHealth(processIdentifier: processIdentifier,
+                                 bundleIdentifier: bundleIdentifier,
+                                 inFlightRequests: inFlightRequests,
+                                 queuedRequests: queuedRequests,
+                                 pendingRefreshes: pendingRefreshes,
+                                 deferredWindowHandlers: deferredWindowHandlers,
+                                 reapedWindows: reapedWindows,
+                                 lastResponseDate: lastResponseDate,
+                                 lastError: lastError,
+                                 lastErrorDate: lastErrorDate)
+    }
+}
+
+/// A property read or write counted by a `ProcessActivity`. The request may start on a
+/// background thread and complete on the main thread; its state is kept under the activity's lock.
+final class QueuedRequest {
+    private let activity: ProcessActivity
+    fileprivate let refresh: Bool
+    // Protected by the activity's lock.
+    fileprivate var started = false
+
+    fileprivate init(activity: ProcessActivity, refresh: Bool) {
+        self.activity = activity
+        self.refresh = refresh
+    }
+
+    /// Called when the request starts executing.
+    func dequeued() {
+        activity.dequeued(self)
+    }
+
+    /// Called when the request completes, whether or not it executed.
+    func completed() {
+        activity.completed(self)
+    }
+}
+
+/// Like `traceRequest(_:_:_:_:requestFunc:)`, but also counts the request against `activity` (the
+/// activity of the element's process) for `State.health()`.
+func traceRequest<T>(
+    _ element: Any,
+    _ request: String,
+    _ arg1: Any,
+    _ arg2: Any? = nil,
+    activity: ProcessActivity?,
+    requestFunc: () throws -> T
+) throws -> T {
+    guard let activity = activity else {
+        return try traceRequest(element, request, arg1, arg2, requestFunc: requestFunc)
+    }
+    activity.requestBegan()
+    do {
+        let result = try traceRequest(element, request, arg1, arg2, requestFunc: requestFunc)
+        activity.requestEnded(error: nil)
+        return result
+    } catch {
+        activity.requestEnded(error: error)
+        throw error
+    }
+}
@@ -0,0 +1,755 @@
+import Cocoa
+
+// MARK: - ModelSnapshot
+
+/// The state of the model as recorded by an `EventJournal`, at a single point in time.
+///
+/// Windows are identified by IDs assigned by the journal, since `Window` objects can't outlive the
+/// windows they refer to. Use `EventJournal.id(of:)` to find the ID of a live window.
+public struct ModelSnapshot: Equatable {
+    public struct WindowState: Equatable {
+        public let id: Int
+        public let processIdentifier: pid_t
+        public internal(set) var title: String
+        public internal(set) var frame: CGRect
+        public internal(set) var isMinimized: Bool
+    }
+
+    public struct ApplicationState: Equatable {
+        public let processIdentifier: pid_t
+        public let bundleIdentifier: String?
+        public internal(set) var isHidden: Bool
+        public internal(set) var mainWindowID: Int?
+        public internal(set) var focusedWindowID: Int?
+    }
+
+    /// The time of the last change included in the snapshot.
+    public internal(set) var date: Date
+    public internal(set) var windows: [Int: WindowState] = [:]
+    public internal(set) var applications: [pid_t: ApplicationState] = [:]
+    public internal(set) var frontmostApplication: pid_t?
+    /// The frames of the screens, in the order Swindler reported them.
+    public internal(set) var screens: [CGRect] = []
+
+    init(date: Date) {
+        self.date = date
+    }
+
+    /// A rough count of the bytes used by the snapshot.
+    var estimatedSize: Int {
+        var size = MemoryLayout<ModelSnapshot>.size + screens.count * MemoryLayout<CGRect>.stride
+        // Dictionaries use about twice the space of their elements.
+        size += 2 * windows.count * MemoryLayout<(Int, WindowState)>.stride
+        size += 2 * applications.count * MemoryLayout<(pid_t, ApplicationState)>.stride
+        for window in windows.values {
+            size += window.title.utf8.count
+        }
+        return size
+    }
+
+    mutating func apply(_ entry: JournalEntry) {
+        date = Date(timeIntervalSinceReferenceDate: entry.time)
+        switch entry.change {
+        case let .windowCreated(id, pid):
+            windows[id] = WindowState(id: id,
+                                      processIdentifier: pid,
+                                      title: "",
+                                      frame: .zero,
+                                      isMinimized: false)
+        case let .windowDestroyed(id):
+            windows.removeValue(forKey: id)
+        case let .windowFrame(id, frame):
+            windows[id]?.frame = frame
+        case let .windowTitle(id, title):
+            windows[id]?.title = title
+        case let .windowMinimized(id, minimized):
+            windows[id]?.isMinimized = minimized
+        case let .applicationLaunched(pid, bundleID):
+            applications[pid] = ApplicationState(processIdentifier: pid,
+                                                 bundleIdentifier: bundleID,
+                                                 isHidden: false,
+                                                 mainWindowID: nil,
+                                                 focusedWindowID: nil)
+        case let .applicationTerminated(pid):
+            applications.removeValue(forKey: pid)
+            windows = windows.filter { $0.value.processIdentifier != pid }
+        case let .applicationHidden(pid, hidden):
+            applications[pid]?.isHidden = hidden
+        case let .mainWindow(pid, id):
+            applications[pid]?.mainWindowID = id
+        case let .focusedWindow(pid, id):
+            applications[pid]?.focusedWindowID = id
+        case let .frontmostApplication(pid):
+            frontmostApplication = pid
+        case let .screens(frames):
+            screens = frames
+        }
+    }
+}
+
+// MARK: - EventJournal
+
+/// Records the events Swindler emits, so the state of the model at any recent time can be
+/// reconstructed. Useful for diagnosing reports like "the window jumped to the wrong screen a few
+/// minutes ago".
+///
+/// Changes are kept in memory, with a full snapshot (checkpoint) taken periodically. When the
+/// journal goes over its memory budget, the oldest checkpoint and the changes that follow it are
+/// dropped. Optionally, everything can also be written to a file with `spill(to:)`.
+///
+/// Must be created and used on the main thread.
+public final class EventJournal {
+    /// The most memory the journal may use, in bytes. This is an estimate; it counts the recorded
+    /// changes and checkpoints, not allocator overhead.
+    public let memoryBudget: Int
+    /// How often a checkpoint is taken.
+    public let checkpointInterval: TimeInterval
+    /// The most changes recorded between two checkpoints. Bounds the work done to reconstruct a
+    /// snapshot.
+    public let maxChangesPerCheckpoint: Int
+
+    /// The estimated number of bytes used by the journal.
+    public private(set) var memoryUsage = 0
+
+    private struct Checkpoint {
+        let snapshot: ModelSnapshot
+        // The sequence number of the first entry after the checkpoint.
+        let sequence: Int
+        let size: Int
+    }
+
+    private let state: State
+    private let idKey = ExtensionKey<Int>()
+    private var nextID = 1
+    private var model: ModelSnapshot
+    private var checkpoints: [Checkpoint] = []
+    private var entries: [JournalEntry] = []
+    // The sequence number of `entries[0]`.
+    private var firstSequence = 0
+    private var isRecording = true
+    private var writer: JournalWriter?
+
+    // Exposed for testing only.
+    var clock: () -> Date = Date.init
+
+    /// Starts recording the events of `state`.
+    ///
+    /// - parameter memoryBudget: See `memoryBudget`. Defaults to 4MB.
+    /// - parameter checkpointInterval: See `checkpointInterval`. Defaults to one minute.
+    public init(state: State,
+                memoryBudget: Int = 4 << 20,
+                checkpointInterval: TimeInterval = 60,
+                maxChangesPerCheckpoint: Int = 2000) {
+        assert(Thread.current.isMainThread)
+        self.memoryBudget = memoryBudget
+        self.checkpointInterval = checkpointInterval
+        self.maxChangesPerCheckpoint = maxChangesPerCheckpoint
+        self.state = state
+        model = ModelSnapshot(date: Date())
+
+        for application in state.runningApplications {
+            for change in changes(launching: application) {
+                model.apply(JournalEntry(time: model.date.timeIntervalSinceReferenceDate,
+                                         change: change))
+            }
+        }
+        model.frontmostApplication = state.frontmostApplication.value?.processIdentifier
+        model.screens = state.screens.map { $0.frame }
+        takeCheckpoint()
+
+        subscribe()
+        MemoryBudget.shared.register(self, priority: .first)
+    }
+
+    deinit {
+        // The IDs are only meaningful to this journal.
+        removeExtension(idKey, fromWindowsOf: state)
+    }
+
+    /// Stops recording. The changes recorded so far are kept.
+    public func stop() {
+        isRecording = false
+        stopSpilling()
+    }
+
+    /// The earliest time a snapshot can be reconstructed for.
+    public var oldestDate: Date? {
+        return checkpoints.first?.snapshot.date
+    }
+
+    /// The ID the journal assigned to `window`, if it has seen it.
+    public func id(of window: Window) -> Int? {
+        return window[idKey]
+    }
+
+    /// Reconstructs the state of the model as it was at `date`.
+    ///
+    /// Returns `nil` if `date` is earlier than `oldestDate`.
+    public func snapshot(at date: Date) -> ModelSnapshot? {
+        assert(Thread.current.isMainThread)
+        guard let index = checkpoints.lastIndex(where: { $0.snapshot.date <= date }) else {
+            return nil
+        }
+        let checkpoint = checkpoints[index]
+        var snapshot = checkpoint.snapshot
+        let time = date.timeIntervalSinceReferenceDate
+        for entry in entries[(checkpoint.sequence - firstSequence)...] {
+            if entry.time > time { break }
+            snapshot.apply(entry)
+        }
+        return snapshot
+    }
+
+    // MARK: Recording
+
+    private func subscribe() {
+        func on<Event: EventType>(_ handler: @escaping (EventJournal, Event) -> Void) {
+            state.on(label: "EventJournal") { [weak self] (event: Event) in
+                guard let self = self, self.isRecording else { return }
+                handler(self, event)
+            }
+        }
+
+        on { (journal, event: WindowCreatedEvent) in
+            journal.record(journal.changes(creating: event.window))
+        }
+        on { (journal, event: WindowDestroyedEvent) in
+            guard let id = journal.id(of: event.window) else { return }
+            journal.record([.windowDestroyed(id: id)])
+        }
+        on { (journal, event: WindowFrameChangedEvent) in
+            guard let id = journal.id(of: event.window) else { return }
+            journal.record([.windowFrame(id: id, event.newValue)])
+        }
+        on { (journal, event: WindowTitleChangedEvent) in
+            guard let id = journal.id(of: event.window) else { return }
+            journal.record([.windowTitle(id: id, event.newValue)])
+        }
+        on { (journal, event: WindowMinimizedChangedEvent) in
+            guard let id = journal.id(of: event.window) else { return }
+            journal.record([.windowMinimized(id: id, event.newValue)])
+        }
+        on { (journal, event: ApplicationLaunchedEvent) in
+            journal.record(journal.changes(launching: event.application))
+        }
+        on { (journal, event: ApplicationTerminatedEvent) in
+            journal.record([.applicationTerminated(event.application.processIdentifier)])
+        }
+        on { (journal, event: ApplicationIsHiddenChangedEvent) in
+            journal.record([.applicationHidden(event.application.processIdentifier,
+                                               event.newValue)])
+        }
+        on { (journal, event: ApplicationMainWindowChangedEvent) in
+            journal.record([.mainWindow(event.application.processIdentifier,
+                                        event.newValue.flatMap(journal.id(of:)))])
+        }
+        on { (journal, event: ApplicationFocusedWindowChangedEvent) in
+            journal.record([.focusedWindow(event.application.processIdentifier,
+                                           event.newValue.flatMap(journal.id(of:)))])
+        }
+        on { (journal, event: FrontmostApplicationChangedEvent) in
+            journal.record([.frontmostApplication(event.newValue?.processIdentifier)])
+        }
+        on { (journal, event: ScreenLayoutChangedEvent) in
+            journal.record([.screens(journal.state.screens.map { $0.frame })])
+        }
+    }
+
+    private func changes(creating window: Window) -> [JournalEntry.Change] {
+        let id: Int
+        if let existing = window[idKey] {
+            id = existing
+        } else {
+            id = nextID
+            nextID += 1
+            window[idKey] = id
+        }
+        return [.windowCreated(id: id, window.application.processIdentifier),
+                .windowFrame(id: id, window.frame.value),
+                .windowTitle(id: id, window.title.value),
+                .windowMinimized(id: id, window.isMinimized.value)]
+    }
+
+    private func changes(launching application: Application) -> [JournalEntry.Change] {
+        let pid = application.processIdentifier
+        var result: [JournalEntry.Change] = [
+            .applicationLaunched(pid, application.bundleIdentifier),
+            .applicationHidden(pid, application.isHidden.value)
+        ]
+        for window in application.knownWindows {
+            result += changes(creating: window)
+        }
+        result.append(.mainWindow(pid, application.mainWindow.value.flatMap(id(of:))))
+        result.append(.focusedWindow(pid, application.focusedWindow.value.flatMap(id(of:))))
+        return result
+    }
+
+    private func record(_ changes: [JournalEntry.Change]) {
+        let time = clock().timeIntervalSinceReferenceDate
+        for change in changes {
+            let entry = JournalEntry(time: time, change: change)
+            model.apply(entry)
+            entries.append(entry)
+            memoryUsage += entry.estimatedSize
+            writer?.write(entry)
+        }
+
+        let sinceCheckpoint = firstSequence + entries.count - checkpoints.last!.sequence
+        if sinceCheckpoint >= maxChangesPerCheckpoint
+            || time - checkpoints.last!.snapshot.date.timeIntervalSinceReferenceDate
+               >= checkpointInterval {
+            takeCheckpoint()
+        }
+        if memoryUsage > memoryBudget {
+            shrink(by: memoryUsage - memoryBudget)
+        }
+        MemoryBudget.shared.cacheDidGrow()
+    }
+
+    private func takeCheckpoint() {
+        let size = model.estimatedSize
+        checkpoints.append(Checkpoint(snapshot: model,
+                                      sequence: firstSequence + entries.count,
+                                      size: size))
+        memoryUsage += size
+        writer?.write(model)
+    }
+
+    /// Drops the oldest checkpoint, and the changes up to the next one, until at least `bytes`
+    /// bytes are freed. The latest checkpoint is always kept. Returns the number of bytes freed.
+    @discardableResult
+    private func shrink(by bytes: Int) -> Int {
+        let target = memoryUsage - bytes
+        let initialUsage = memoryUsage
+        while memoryUsage > target {
+            if checkpoints.count == 1 {
+                // If nothing was recorded since the only checkpoint, there is nothing to drop.
+                guard firstSequence + entries.count > checkpoints[0].sequence else { break }
+                // Everything recorded is after the only checkpoint; start over from a new one.
+                takeCheckpoint()
+            }
+            let dropped = checkpoints.removeFirst()
+            let end = checkpoints[0].sequence - firstSequence
+            memoryUsage -= dropped.size
+            memoryUsage -= entries[..<end].reduce(0) { $0 + $1.estimatedSize }
+            entries.removeFirst(end)
+            firstSequence += end
+        }
+        return initialUsage - memoryUsage
+    }
+
+    // MARK: Spilling to disk
+
+    /// Starts writing everything recorded from now on to `url`, replacing its contents.
+    ///
+    /// Writes happen asynchronously, in a compact binary format. Use
+    /// `EventJournal.snapshot(fromFile:at:)` to read the file. The file is not bound by the memory
+    /// budget.
+    ///
+    /// - throws: An error if the file can't be created.
+    public func spill(to url: URL) throws {
+        assert(Thread.current.isMainThread)
+        stopSpilling()
+        writer = try JournalWriter(url: url)
+        writer!.write(model)
+    }
+
+    /// Stops writing to the file given to `spill(to:)`, after everything recorded so far is
+    /// written.
+    public func stopSpilling() {
+        writer?.close()
+        writer = nil
+    }
+
+    /// Waits for everything recorded so far to be written to the spill file.
+    func waitForSpill() {
+        writer?.flush()
+        writer?.wait()
+    }
+
+    /// Reconstructs the state of the model at `date` from a file written by `spill(to:)`.
+    ///
+    /// Returns `nil` if the file starts after `date`.
+    ///
+    /// - throws: `JournalError` if the file is not a journal, or an error if it can't be read.
+    public static func snapshot(fromFile url: URL, at date: Date) throws -> ModelSnapshot? {
+        var reader = JournalReader(data: try Data(contentsOf: url, options: .alwaysMapped))
+        try reader.readHeader()
+        let time = date.timeIntervalSinceReferenceDate
+        var snapshot: ModelSnapshot?
+        while !reader.isAtEnd {
+            switch try reader.readRecord() {
+            case .checkpoint(let checkpoint):
+                if checkpoint.date > date { return snapshot }
+                snapshot = checkpoint
+            case .entry(let entry):
+                if entry.time > time { return snapshot }
+                snapshot?.apply(entry)
+            }
+        }
+        return snapshot
+    }
+}
+
+extension EventJournal: EvictableCache {
+    public var cacheName: String { return "event journal" }
+    public var estimatedCost: Int { return memoryUsage }
+    public func evict(bytes: Int) -> Int { return shrink(by: bytes) }
+}
+
+/// An error reading a journal file.
+public enum JournalError: Error {
+    /// The file is not a journal written by this version of Swindler.
+    case invalidFormat
+    /// The file ended in the middle of a record.
+    case truncated
+}
+
+// MARK: - JournalEntry
+
+struct JournalEntry {
+    // Cases are kept small so entries stay compact; a new window is recorded as `windowCreated`
+    // followed by one change for each of its properties.
+    enum Change {
+        case windowCreated(id: Int, pid_t)
+        case windowDestroyed(id: Int)
+        case windowFrame(id: Int, CGRect)
+        case windowTitle(id: Int, String)
+        case windowMinimized(id: Int, Bool)
+        case applicationLaunched(pid_t, String?)
+        case applicationTerminated(pid_t)
+        case applicationHidden(pid_t, Bool)
+        case mainWindow(pid_t, Int?)
+        case focusedWindow(pid_t, Int?)
+        case frontmostApplication(pid_t?)
+        case screens([CGRect])
+    }
+
+    // Seconds since the reference date; cheaper to store and compare than Date.
+    let time: TimeInterval
+    let change: Change
+
+    var estimatedSize: Int {
+        var size = MemoryLayout<JournalEntry>.stride
+        switch change {
+        case .windowTitle(_, let title):
+            size += title.utf8.count
+        case .applicationLaunched(_, let bundleID):
+            size += bundleID?.utf8.count ?? 0
+        case .screens(let frames):
+            size += frames.count * MemoryLayout<CGRect>.stride
+        default:
+            break
+        }
+        return size
+    }
+}
+
+// MARK: - File format
+//
+// A journal file is the magic number followed by a sequence of records. Each record starts with a
+// one-byte tag and the time it was recorded. All numbers are little-endian.
+
+private let journalMagic: UInt32 = 0x314A5753 // "SWJ1"
+
+private enum JournalTag: UInt8 {
+    case checkpoint
+    case windowCreated, windowDestroyed, windowFrame, windowTitle, windowMinimized
+    case applicationLaunched, applicationTerminated, applicationHidden
+    case mainWindow, focusedWindow, frontmostApplication, screens
+}
+
+private enum JournalRecord {
+    case checkpoint(ModelSnapshot)
+    case entry(JournalEntry)
+}
+
+/// Encodes records on the main thread and writes them to the file on a background queue.
+private final class JournalWriter {
+    private let handle: FileHandle
+    private let queue = DispatchQueue(label: "Swindler.JournalWriter")
+    private var buffer = BinaryWriter()
+    private var flushScheduled = false
+
+    // Flush once this much is buffered, or a second after the first unflushed record.
+    private static let flushSize = 16 << 10
+    private static let flushDelay: TimeInterval = 1
+
+    init(url: URL) throws {
+        guard FileManager.default.createFile(atPath: url.path, contents: nil) else {
+            throw CocoaError(.fileWriteUnknown, userInfo: [NSFilePathErrorKey: url.path])
+        }
+        handle = try FileHandle(forWritingTo: url)
+        buffer.write(journalMagic)
+    }
+
+    func write(_ entry: JournalEntry) {
+        buffer.write(entry)
+        didWrite()
+    }
+
+    func write(_ snapshot: ModelSnapshot) {
+        buffer.write(snapshot)
+        didWrite()
+    }
+
+    private func didWrite() {
+        if buffer.data.count >= JournalWriter.flushSize {
+            flush()
+        } else if !flushScheduled {
+            flushScheduled = true
+            let deadline = DispatchTime.now() + JournalWriter.flushDelay
+            DispatchQueue.main.asyncAfter(deadline: deadline) { [weak self] in
+                self?.flush()
+            }
+        }
+    }
+
+    func flush() {
+        flushScheduled = false
+        guard !buffer.data.isEmpty else { return }
+        let data = buffer.data
+        buffer = BinaryWriter()
+        queue.async { [handle] in
+            handle.write(data)
+        }
+    }
+
+    func wait() {
+        queue.sync {}
+    }
+
+    func close() {
+        flush()
+        queue.async { [handle] in
+            handle.closeFile()
+        }
+    }
+}
+
+private struct BinaryWriter {
+    private(set) var data = Data()
+
+    mutating func write<T: FixedWidthInteger>(_ value: T) {
+        var little = value.littleEndian
+        withUnsafeBytes(of: &little) { data.append(contentsOf: $0) }
+    }
+
+    mutating func write(_ value: Double) {
+        write(value.bitPattern)
+    }
+
+    mutating func write(_ value: Bool) {
+        write(UInt8(value ? 1 : 0))
+    }
+
+    mutating func write(_ rect: CGRect) {
+        write(Double(rect.origin.x))
+        write(Double(rect.origin.y))
+        write(Double(rect.size.width))
+        write(Double(rect.size.height))
+    }
+
+    mutating func write(_ string: String?) {
+        guard let string = string else {
+            write(UInt32.max)
+            return
+        }
+        let utf8 = Array(string.utf8)
+        write(UInt32(utf8.count))
+        data.append(contentsOf: utf8)
+    }
+
+    // IDs and optional IDs; -1 stands for nil.
+    mutating func write(id: Int?) {
+        write(Int64(id ?? -1))
+    }
+
+    mutating func write(_ tag: JournalTag, _ time: TimeInterval) {
+        write(tag.rawValue)
+        write(time)
+    }
+
+    mutating func write(_ entry: JournalEntry) {
+        let time = entry.time
+        switch entry.change {
+        case let .windowCreated(id, pid):
+            write(.windowCreated, time); write(id: id); write(pid)
+        case let .windowDestroyed(id):
+            write(.windowDestroyed, time); write(id: id)
+        case let .windowFrame(id, frame):
+            write(.windowFrame, time); write(id: id); write(frame)
+        case let .windowTitle(id, title):
+            write(.windowTitle, time); write(id: id); write(title)
+        case let .windowMinimized(id, minimized):
+            write(.windowMinimized, time); write(id: id); write(minimized)
+        case let .applicationLaunched(pid, bundleID):
+            write(.applicationLaunched, time); write(pid); write(bundleID)
+        case let .applicationTerminated(pid):
+            write(.applicationTerminated, time); write(pid)
+        case let .applicationHidden(pid, hidden):
+            write(.applicationHidden, time); write(pid); write(hidden)
+        case let .mainWindow(pid, id):
+            write(.mainWindow, time); write(pid); write(id: id)
+        case let .focusedWindow(pid, id):
+            write(.focusedWindow, time); write(pid); write(id: id)
+        case let .frontmostApplication(pid):
+            write(.frontmostApplication, time); write(id: pid.map(Int.init))
+        case let .screens(frames):
+            write(.screens, time); write(frames)
+        }
+    }
+
+    mutating func write(_ frames: [CGRect]) {
+        write(UInt32(frames.count))
+        frames.forEach { write($0) }
+    }
+
+    mutating func write(_ snapshot: ModelSnapshot) {
+        write(.checkpoint, snapshot.date.timeIntervalSinceReferenceDate)
+        write(id: snapshot.frontmostApplication.map(Int.init))
+        write(snapshot.screens)
+        write(UInt32(snapshot.applications.count))
+        for app in snapshot.applications.values {
+            write(app.processIdentifier)
+            write(app.bundleIdentifier)
+            write(app.isHidden)
+            write(id: app.mainWindowID)
+            write(id: app.focusedWindowID)
+        }
+        write(UInt32(snapshot.windows.count))
+        for window in snapshot.windows.values {
+            write(id: window.id)
+            write(window.processIdentifier)
+            write(window.title)
+            write(window.frame)
+            write(window.isMinimized)
+        }
+    }
+}
+
+private struct JournalReader {
+    let data: Data
+    private var offset: Int
+
+    init(data: Data) {
+        self.data = data
+        offset = data.startIndex
+    }
+
+    var isAtEnd: Bool { return offset == data.endIndex }
+
+    mutating func readHeader() throws {
+        guard try read(UInt32.self) == journalMagic else {
+            throw JournalError.invalidFormat
+        }
+    }
+
+    mutating func read<T: FixedWidthInteger>(_: T.Type) throws -> T {
+        let size = MemoryLayout<T>.size
+        guard offset + size <= data.endIndex else { throw JournalError.truncated }
+        var value = T.zero
+        withUnsafeMutableBytes(of: &value) {
+            data.copyBytes(to: $0, from: offset..<offset + size)
+        }
+        offset += size
+        return T(littleEndian: value)
+    }
+
+    mutating func readDouble() throws -> Double {
+        return Double(bitPattern: try read(UInt64.self))
+    }
+
+    mutating func readBool() throws -> Bool {
+        return try read(UInt8.self) != 0
+    }
+
+    mutating func readRect() throws -> CGRect {
+        return CGRect(x: try readDouble(),
+                      y: try readDouble(),
+                      width: try readDouble(),
+                      height: try readDouble())
+    }
+
+    mutating func readString() throws -> String? {
+        let count = try read(UInt32.self)
+        if count == UInt32.max { return nil }
+        guard offset + Int(count) <= data.endIndex else { throw JournalError.truncated }
+        let bytes = data[offset..<offset + Int(count)]
+        offset += Int(count)
+        return String(decoding: bytes, as: UTF8.self)
+    }
+
+    mutating func readID() throws -> Int? {
+        let id = try read(Int64.self)
+        return id < 0 ? nil : Int(id)
+    }
+
+    mutating func readPID() throws -> pid_t {
+        return try read(pid_t.self)
+    }
+
+    mutating func readFrames() throws -> [CGRect] {
+        return try (0..<read(UInt32.self)).map { _ in try readRect() }
+    }
+
+    mutating func readRecord() throws -> JournalRecord {
+        guard let tag = JournalTag(rawValue: try read(UInt8.self)) else {
+            throw JournalError.invalidFormat
+        }
+        let time = try readDouble()
+        let change: JournalEntry.Change
+        switch tag {
+        case .checkpoint:
+            return .checkpoint(try readCheckpoint(time))
+        case .windowCreated:
+            change = .windowCreated(id: try readID() ?? 0, try readPID())
+        case .windowDestroyed:
+            change = .windowDestroyed(id: try readID() ?? 0)
+        case .windowFrame:
+            change = .windowFrame(id: try readID() ?? 0, try readRect())
+        case .windowTitle:
+            change = .windowTitle(id: try readID() ?? 0, try readString() ?? "")
+        case .windowMinimized:
+            change = .windowMinimized(id: try readID() ?? 0, try readBool())
+        case .applicationLaunched:
+            change = .applicationLaunched(try readPID(), try readString())
+        case .applicationTerminated:
+            change = .applicationTerminated(try readPID())
+        case .applicationHidden:
+            change = .applicationHidden(try readPID(), try readBool())
+        case .mainWindow:
+            change = .mainWindow(try readPID(), try readID())
+        case .focusedWindow:
+            change = .focusedWindow(try readPID(), try readID())
+        case .frontmostApplication:
+            change = .frontmostApplication(try readID().map { pid_t($0) })
+        case .screens:
+            change = .screens(try readFrames())
+        }
+        return .entry(JournalEntry(time: time, change: change))
+    }
+
+    private mutating func readCheckpoint(_ time: TimeInterval) throws -> ModelSnapshot {
+        var snapshot = ModelSnapshot(date: Date(timeIntervalSinceReferenceDate: time))
+        snapshot.frontmostApplication = try readID().map { pid_t($0) }
+        snapshot.screens = try readFrames()
+        for _ in 0..<(try read(UInt32.self)) {
+            let app = ModelSnapshot.ApplicationState(processIdentifier: try readPID(),
+                                                     bundleIdentifier: try readString(),
+                                                     isHidden: try readBool(),
+                                                     mainWindowID: try readID(),
+                                                     focusedWindowID: try readID())
+            snapshot.applications[app.processIdentifier] = app
+        }
+        for _ in 0..<(try read(UInt32.self)) {
+            let window = ModelSnapshot.WindowState(id: try readID() ?? 0,
+                                                   processIdentifier: try readPID(),
+                                                   title: try readString() ?? "",
+                                                   frame: try readRect(),
+                                                   isMinimized: try readBool())
+            snapshot.windows[window.id] = window
+        }
+        return snapshot
+    }
+}
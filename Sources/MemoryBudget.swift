@@ -0,0 +1,160 @@
+import Foundation
+
+// MARK: - EvictableCache
+
+/// A cache whose contents can be dropped to save memory.
+///
+/// Register caches with `MemoryBudget.register(_:priority:)`. Swindler registers its own, and you
+/// can register yours to have them shed along with Swindler's.
+public protocol EvictableCache: AnyObject {
+    /// A name for the cache, for reports.
+    var cacheName: String { get }
+    /// An estimate of the bytes used by the cache.
+    var estimatedCost: Int { get }
+    /// Frees about `bytes` bytes, or everything if the cache is smaller. Returns the estimated
+    /// number of bytes freed.
+    func evict(bytes: Int) -> Int
+}
+
+/// The order in which caches are shed when over budget.
+public enum EvictionPriority: Int, Comparable {
+    /// Data that is only kept for diagnostics, like journals and reports.
+    case first
+    /// Data that can be rebuilt or is unlikely to be needed.
+    case normal
+    /// Data whose loss degrades behavior, like deferred updates.
+    case last
+
+    public static func < (lhs: EvictionPriority, rhs: EvictionPriority) -> Bool {
+        return lhs.rawValue < rhs.rawValue
+    }
+}
+
+// MARK: - MemoryBudget
+
+/// A limit on the memory used by Swindler's caches.
+///
+/// When the registered caches go over `limit`, they are shed in priority order until they fit.
+/// When the system signals memory pressure, they are shed further: to half the limit on a warning,
+/// and entirely on a critical signal.
+///
+/// There is one budget per process, shared by every `State`. Must be used on the main thread.
+public final class MemoryBudget {
+    static let shared = MemoryBudget()
+
+    /// The most memory the registered caches may use together, in bytes. Defaults to 32MB.
+    public var limit = 32 << 20 {
+        didSet { cacheDidGrow() }
+    }
+
+    /// The number of bytes evicted so far.
+    public private(set) var evictedBytes = 0
+
+    private struct Registration {
+        weak var cache: EvictableCache?
+        let priority: EvictionPriority
+    }
+    private var registrations: [Registration] = []
+    private var isCheckScheduled = false
+    private var pressureSource: DispatchSourceMemoryPressure?
+
+    init() {}
+
+    /// Adds `cache` to the budget. The cache is held weakly, and removed once it is deallocated.
+    public func register(_ cache: EvictableCache, priority: EvictionPriority) {
+        assert(Thread.current.isMainThread)
+        registrations.removeAll { $0.cache == nil || $0.cache === cache }
+        registrations.append(Registration(cache: cache, priority: priority))
+        startWatchingMemoryPressure()
+    }
+
+    /// Removes `cache` from the budget.
+    public func unregister(_ cache: EvictableCache) {
+        assert(Thread.current.isMainThread)
+        registrations.removeAll { $0.cache == nil || $0.cache === cache }
+    }
+
+    /// The estimated cost of each registered cache, in bytes, by name. Caches with the same name
+    /// are added together.
+    public func costs() -> [String: Int] {
+        assert(Thread.current.isMainThread)
+        var result: [String: Int] = [:]
+        for registration in registrations {
+            guard let cache = registration.cache else { continue }
+            result[cache.cacheName, default: 0] += cache.estimatedCost
+        }
+        return result
+    }
+
+    /// The estimated cost of all registered caches, in bytes.
+    public var totalCost: Int {
+        assert(Thread.current.isMainThread)
+        return registrations.reduce(0) { $0 + ($1.cache?.estimatedCost ?? 0) }
+    }
+
+    /// Evicts from registered caches, in priority order and largest first within a priority, until
+    /// their total cost is at most `target`. Returns the number of bytes evicted.
+    @discardableResult
+    public func shed(toCost target: Int) -> Int {
+        assert(Thread.current.isMainThread)
+        registrations.removeAll { $0.cache == nil }
+        var excess = totalCost - target
+        guard excess > 0 else { return 0 }
+
+        var ordered: [(cache: EvictableCache, priority: EvictionPriority, cost: Int)] = []
+        for registration in registrations {
+            guard let cache = registration.cache else { continue }
+            ordered.append((cache, registration.priority, cache.estimatedCost))
+        }
+        ordered.sort { ($0.priority, -$0.cost) < ($1.priority, -$1.cost) }
+
+        var evicted = 0
+        for entry in ordered where excess > 0 && entry.cost > 0 {
+            let freed = entry.cache.evict(bytes: min(excess, entry.cost))
+            evicted += freed
+            excess -= freed
+        }
+        evictedBytes += evicted
+        log.info("Evicted \(evicted) bytes from Swindler caches to fit in \(target) bytes")
+        return evicted
+    }
+
+    /// Called by caches when they grow. Checks the budget once per run loop turn.
+    func cacheDidGrow() {
+        guard !isCheckScheduled else { return }
+        isCheckScheduled = true
+        DispatchQueue.main.async {
+            self.isCheckScheduled = false
+            if self.totalCost > self.limit {
+                self.shed(toCost: self.limit)
+            }
+        }
+    }
+
+    private func startWatchingMemoryPressure() {
+        guard pressureSource == nil else { return }
+        let source = DispatchSource.makeMemoryPressureSource(eventMask: [.warning, .critical],
+                                                             queue: .main)
+        source.setEventHandler { [weak self, weak source] in
+            guard let self = self, let event = source?.data else { return }
+            self.handleMemoryPressure(event)
+        }
+        source.resume()
+        pressureSource = source
+    }
+
+    func handleMemoryPressure(_ event: DispatchSource.MemoryPressureEvent) {
+        if event.contains(.critical) {
+            log.notice("Critical memory pressure; evicting all Swindler caches")
+            shed(toCost: 0)
+        } else if event.contains(.warning) {
+            shed(toCost: limit / 2)
+        }
+    }
+}
+
+extension State {
+    /// The memory budget for Swindler's caches. This is shared by all `State` objects in the
+    /// process.
+    public var memoryBudget: MemoryBudget { return MemoryBudget.shared }
+}
@@ -0,0 +1,520 @@
+import Foundation
+
+// MARK: - Metrics
+
+/// Measurements of Swindler's own behavior, for diagnosing performance problems in your app.
+///
+/// There is one set of metrics per process, shared by every `State`. Unless noted otherwise,
+/// members are safe to use from any thread.
+public final class Metrics {
+    static let shared = Metrics()
+
+    private let lock = NSLock()
+    private var stallDurations_ = Histogram(bucketBounds: [50, 100, 250, 500, 1000, 2500, 5000])
+    private var recentStalls_: [StallReport] = []
+    private var focusLatencies_ = Histogram(bucketBounds: [10, 25, 50, 100, 250, 500, 1000])
+    private var watchdog: StallWatchdog?
+    private let handlerStats = NSHashTable<HandlerStats>.weakObjects()
+    private var maxRecentStalls_ = 20
+
+    /// The number of stall reports kept in `recentStalls`.
+    public var maxRecentStalls: Int {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return maxRecentStalls_
+        }
+        set {
+            lock.lock()
+            defer { lock.unlock() }
+            maxRecentStalls_ = newValue
+        }
+    }
+
+    init() {}
+
+    /// Durations of main thread stalls detected by the watchdog, in milliseconds.
+    public var stallDurations: Histogram {
+        lock.lock()
+        defer { lock.unlock() }
+        return stallDurations_
+    }
+
+    /// The most recent stalls detected by the watchdog, oldest first.
+    public var recentStalls: [StallReport] {
+        lock.lock()
+        defer { lock.unlock() }
+        return recentStalls_
+    }
+
+    /// The latency of each `FocusChangedEvent`, in milliseconds.
+    public var focusTransitionLatencies: Histogram {
+        lock.lock()
+        defer { lock.unlock() }
+        return focusLatencies_
+    }
+
+    /// Whether the stall watchdog is running.
+    public var isStallWatchdogRunning: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return watchdog != nil
+    }
+
+    /// Starts a background thread that watches for the main thread being blocked for longer than
+    /// `threshold`.
+    ///
+    /// Each stall is recorded in `stallDurations` and `recentStalls`, along with what Swindler was
+    /// doing when the stall was detected. While the watchdog runs, Swindler does a small amount of
+    /// extra bookkeeping on every event it delivers.
+    ///
+    /// - parameter onStall: Called on the main thread after each stall ends.
+    public func startStallWatchdog(threshold: TimeInterval = 0.1,
+                                   onStall: ((StallReport) -> Void)? = nil) {
+        lock.lock()
+        defer { lock.unlock() }
+        guard watchdog == nil else { return }
+        let watchdog = StallWatchdog(threshold: threshold,
+                                     activity: activity) { [weak self] report in
+            self?.record(report)
+            if let onStall = onStall {
+                DispatchQueue.main.async { onStall(report) }
+            }
+        }
+        self.watchdog = watchdog
+        activity.isTracking = true
+        watchdog.start()
+    }
+
+    /// Stops the stall watchdog. Recorded metrics are kept.
+    public func stopStallWatchdog() {
+        lock.lock()
+        defer { lock.unlock() }
+        watchdog?.stop()
+        watchdog = nil
+        activity.isTracking = false
+    }
+
+    /// Clears all recorded metrics.
+    ///
+    /// - note: Must be called on the main thread.
+    public func reset() {
+        assert(Thread.current.isMainThread)
+        lock.lock()
+        defer { lock.unlock() }
+        stallDurations_.reset()
+        recentStalls_ = []
+        focusLatencies_.reset()
+        for stats in handlerStats.allObjects {
+            stats.reset()
+        }
+    }
+
+    func recordFocusTransition(latency: TimeInterval) {
+        lock.lock()
+        defer { lock.unlock() }
+        focusLatencies_.record(latency * 1000)
+    }
+
+    private func record(_ report: StallReport) {
+        lock.lock()
+        defer { lock.unlock() }
+        stallDurations_.record(report.duration * 1000)
+        recentStalls_.append(report)
+        if recentStalls_.count > maxRecentStalls_ {
+            recentStalls_.removeFirst(recentStalls_.count - maxRecentStalls_)
+        }
+        log.notice("Main thread stalled for \(Int(report.duration * 1000))ms: \(report)")
+    }
+
+    // MARK: Handler profiling
+    //
+    // Handlers run on the main thread, so these members must only be used there.
+
+    /// Whether the CPU time of event handlers is measured. Off by default.
+    ///
+    /// Measuring costs two clock reads per handler call, including Swindler's own handlers.
+    public var isHandlerProfilingEnabled = false
+
+    /// The default CPU time budget for a single call to an event handler, in seconds. A warning is
+    /// logged whenever a handler goes over its budget. Set to `nil` to disable warnings.
+    ///
+    /// A budget passed to `State.on(label:budget:_:)` takes precedence.
+    public var handlerBudget: TimeInterval? = 0.016
+
+    /// Called on the main thread when a handler goes over its budget, with the CPU time it took.
+    public var onHandlerOverBudget: ((HandlerReport, TimeInterval) -> Void)?
+
+    /// The handlers that have used the most CPU time in total, most expensive first. Handlers that
+    /// haven't been called are left out.
+    public func slowestHandlers(limit: Int = 10) -> [HandlerReport] {
+        let called = handlerReports().filter { $0.calls > 0 }
+        return Array(called.sorted { $0.totalCPUTime > $1.totalCPUTime }.prefix(limit))
+    }
+
+    /// The total CPU time spent in handlers for each event type, in seconds.
+    public func handlerCPUTimeByEvent() -> [String: TimeInterval] {
+        var result: [String: TimeInterval] = [:]
+        for report in handlerReports() {
+            result[report.eventType, default: 0] += report.totalCPUTime
+        }
+        return result
+    }
+
+    /// The total CPU time spent in handlers for each named caller of `initialize`, in seconds.
+    /// Handlers of unnamed callers, and Swindler's own, are left out.
+    public func handlerCPUTimeByConsumer() -> [String: TimeInterval] {
+        var result: [String: TimeInterval] = [:]
+        for report in handlerReports() {
+            guard let consumer = report.consumer else { continue }
+            result[consumer, default: 0] += report.totalCPUTime
+        }
+        return result
+    }
+
+    private func handlerReports() -> [HandlerReport] {
+        assert(Thread.current.isMainThread)
+        lock.lock()
+        let allStats = handlerStats.allObjects
+        lock.unlock()
+        return allStats.map { $0.report }
+    }
+
+    // The CPU time used by handlers nested in each handler being profiled, innermost last.
+    private var nestedCPUTimes: [TimeInterval] = []
+
+    /// Starts profiling a handler call. Returns the start time to pass to `endProfiling`.
+    func beginProfiling() -> TimeInterval {
+        nestedCPUTimes.append(0)
+        return threadCPUTime()
+    }
+
+    /// Ends profiling a handler call, and returns the CPU time it used itself, excluding the
+    /// handlers of events it delivered.
+    func endProfiling(start: TimeInterval) -> TimeInterval {
+        let total = threadCPUTime() - start
+        let nested = nestedCPUTimes.removeLast()
+        if !nestedCPUTimes.isEmpty {
+            nestedCPUTimes[nestedCPUTimes.count - 1] += total
+        }
+        return total - nested
+    }
+
+    func register(_ stats: HandlerStats) {
+        lock.lock()
+        defer { lock.unlock() }
+        handlerStats.add(stats)
+    }
+
+    // MARK: Activity
+
+    /// What Swindler is currently doing, for stall reports.
+    let activity = Activity()
+}
+
+extension State {
+    /// Performance metrics. These are shared by all `State` objects in the process.
+    public var metrics: Metrics { return Metrics.shared }
+}
+
+// MARK: - Histogram
+
+/// A histogram of values with fixed bucket bounds.
+public struct Histogram {
+    /// The inclusive upper bound of each bucket, in increasing order. Values larger than the last
+    /// bound go in an extra overflow bucket.
+    public let bucketBounds: [Double]
+    /// The number of values in each bucket. Has one more element than `bucketBounds`.
+    public private(set) var bucketCounts: [Int]
+    /// The number of values recorded.
+    public private(set) var count: Int = 0
+    /// The sum of all values recorded.
+    public private(set) var sum: Double = 0
+    /// The largest value recorded, or 0 if none have been.
+    public private(set) var max: Double = 0
+
+    public init(bucketBounds: [Double]) {
+        self.bucketBounds = bucketBounds
+        bucketCounts = Array(repeating: 0, count: bucketBounds.count + 1)
+    }
+
+    /// The mean of all values recorded, or 0 if none have been.
+    public var mean: Double { return count == 0 ? 0 : sum / Double(count) }
+
+    public mutating func record(_ value: Double) {
+        let bucket = bucketBounds.firstIndex(where: { value <= $0 }) ?? bucketBounds.count
+        bucketCounts[bucket] += 1
+        count += 1
+        sum += value
+        max = Swift.max(max, value)
+    }
+
+    mutating func reset() {
+        self = Histogram(bucketBounds: bucketBounds)
+    }
+}
+
+// MARK: - Stall reports
+
+/// A period during which the main thread didn't respond.
+public struct StallReport: CustomStringConvertible {
+    /// How long the main thread was unresponsive, in seconds. This is at least the watchdog
+    /// threshold.
+    public internal(set) var duration: TimeInterval
+    /// When the stall started.
+    public let startDate: Date
+    /// The event Swindler was delivering when the stall was detected, if any.
+    public let event: String?
+    /// The handler of `event` that was running, in the order handlers were registered.
+    public let handlerIndex: Int?
+    /// The label of the handler that was running, if it was given one.
+    public let handlerLabel: String?
+    /// Calls that were blocked waiting for the main thread when the stall was detected.
+    public let pendingSyncHops: [String]
+
+    public var description: String {
+        var parts: [String] = []
+        if let event = event {
+            parts.append("in handler \(handlerLabel ?? String(handlerIndex ?? 0)) for \(event)")
+        } else {
+            parts.append("outside of Swindler event delivery")
+        }
+        if !pendingSyncHops.isEmpty {
+            parts.append("waiting: \(pendingSyncHops.joined(separator: ", "))")
+        }
+        return parts.joined(separator: "; ")
+    }
+}
+
+/// Tracks what Swindler is doing, so the watchdog can report it.
+///
+/// Updates only take an uncontended lock unless the watchdog is running.
+final class Activity {
+    private let lock = NSLock()
+    private var isTracking_ = false
+
+    fileprivate(set) var isTracking: Bool {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return isTracking_
+        }
+        set {
+            lock.lock()
+            defer { lock.unlock() }
+            isTracking_ = newValue
+        }
+    }
+
+    // Handlers being run, innermost last. An event delivered from inside a handler runs its own
+    // handlers on top of the outer one.
+    private var handlers: [(event: String, index: Int, label: String?)] = []
+    private var syncHops: [Int: String] = [:]
+    private var nextSyncHopID = 0
+
+    /// Records a handler that is about to run. Returns a token to pass to `endHandler`.
+    func beginHandler(event: String, index: Int, label: String?) -> Int? {
+        lock.lock()
+        defer { lock.unlock() }
+        guard isTracking_ else { return nil }
+        handlers.append((event, index, label))
+        return handlers.count - 1
+    }
+
+    /// Records that a handler returned, making the handler that delivered its event (if any) the
+    /// current one again.
+    func endHandler(_ token: Int?) {
+        guard let token = token else { return }
+        lock.lock()
+        defer { lock.unlock() }
+        // Tracking may have been restarted since, so the stack can be shorter than expected.
+        handlers.removeSubrange(min(token, handlers.count)...)
+    }
+
+    /// Records a call that is about to block waiting for the main thread. Returns an ID to pass to
+    /// `endSyncHop`.
+    func beginSyncHop(_ site: String) -> Int? {
+        lock.lock()
+        defer { lock.unlock() }
+        guard isTracking_ else { return nil }
+        let id = nextSyncHopID
+        nextSyncHopID += 1
+        syncHops[id] = site
+        return id
+    }
+
+    func endSyncHop(_ id: Int?) {
+        guard let id = id else { return }
+        lock.lock()
+        defer { lock.unlock() }
+        syncHops.removeValue(forKey: id)
+    }
+
+    /// The number of calls blocked waiting for the main thread.
+    var pendingSyncHopCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return syncHops.count
+    }
+
+    /// Returns a report of the current activity for a stall that started at `startDate`.
+    func report(startDate: Date) -> StallReport {
+        lock.lock()
+        defer { lock.unlock() }
+        let hops = syncHops.sorted(by: { $0.key < $1.key }).map { $0.value }
+        let handler = handlers.last
+        return StallReport(duration: 0,
+                           startDate: startDate,
+                           event: handler?.event,
+                           handlerIndex: handler?.index,
+                           handlerLabel: handler?.label,
+                           pendingSyncHops: hops)
+    }
+}
+
+// MARK: - Handler profiling
+
+/// CPU time used by one event subscription.
+public struct HandlerReport {
+    /// The label given when subscribing, if any.
+    public let label: String?
+    /// The name of the `initialize` caller that subscribed, if it gave one.
+    public let consumer: String?
+    /// The name of the event type handled.
+    public let eventType: String
+    /// The number of times the handler was called.
+    public let calls: Int
+    /// The total CPU time used by the handler, in seconds. Handlers of events it caused to be
+    /// delivered synchronously are counted separately, so totals can be added up.
+    public let totalCPUTime: TimeInterval
+    /// The most CPU time used by a single call, in seconds.
+    public let maxCPUTime: TimeInterval
+    /// The number of calls that went over the handler's budget.
+    public let overBudgetCalls: Int
+
+    /// The mean CPU time per call, in seconds.
+    public var meanCPUTime: TimeInterval { return calls == 0 ? 0 : totalCPUTime / Double(calls) }
+}
+
+/// Accumulates the CPU time of one subscription. Only used on the main thread.
+final class HandlerStats {
+    let label: String?
+    let eventType: String
+    let budget: TimeInterval?
+    let consumer: String?
+
+    private var calls = 0
+    private var totalCPUTime: TimeInterval = 0
+    private var maxCPUTime: TimeInterval = 0
+    private var overBudgetCalls = 0
+
+    init(label: String?, eventType: String, budget: TimeInterval?, consumer: String? = nil) {
+        self.label = label
+        self.eventType = eventType
+        self.budget = budget
+        self.consumer = consumer
+    }
+
+    var report: HandlerReport {
+        return HandlerReport(label: label,
+                             consumer: consumer,
+                             eventType: eventType,
+                             calls: calls,
+                             totalCPUTime: totalCPUTime,
+                             maxCPUTime: maxCPUTime,
+                             overBudgetCalls: overBudgetCalls)
+    }
+
+    func record(_ time: TimeInterval) {
+        calls += 1
+        totalCPUTime += time
+        maxCPUTime = max(maxCPUTime, time)
+
+        let metrics = Metrics.shared
+        if let budget = budget ?? metrics.handlerBudget, time > budget {
+            overBudgetCalls += 1
+            log.warn("Handler \(label ?? "<unlabeled>") for \(eventType) took "
+                   + "\(Int(time * 1000))ms of CPU time, over its budget of "
+                   + "\(Int(budget * 1000))ms")
+            metrics.onHandlerOverBudget?(report, time)
+        }
+    }
+
+    func reset() {
+        calls = 0
+        totalCPUTime = 0
+        maxCPUTime = 0
+        overBudgetCalls = 0
+    }
+}
+
+/// The CPU time used by the current thread so far, in seconds.
+func threadCPUTime() -> TimeInterval {
+    var time = timespec()
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time)
+    return TimeInterval(time.tv_sec) + TimeInterval(time.tv_nsec) / 1e9
+}
+
+// MARK: - StallWatchdog
+
+/// Pings the main thread from a background thread and reports when it takes too long to respond.
+private final class StallWatchdog {
+    private let threshold: TimeInterval
+    private let activity: Activity
+    private let onStall: (StallReport) -> Void
+    private var thread: Thread?
+
+    init(threshold: TimeInterval, activity: Activity, onStall: @escaping (StallReport) -> Void) {
+        self.threshold = threshold
+        self.activity = activity
+        self.onStall = onStall
+    }
+
+    func start() {
+        // The thread keeps the watchdog alive until it notices it has been cancelled.
+        let thread = Thread { self.run() }
+        thread.name = "Swindler stall watchdog"
+        thread.qualityOfService = .userInteractive
+        self.thread = thread
+        thread.start()
+    }
+
+    func stop() {
+        thread?.cancel()
+    }
+
+    private func run() {
+        let current = Thread.current
+        while !current.isCancelled {
+            let responded = DispatchSemaphore(value: 0)
+            let startDate = Date()
+            let start = DispatchTime.now()
+            DispatchQueue.main.async { responded.signal() }
+
+            if responded.wait(timeout: start + threshold) == .timedOut {
+                // Look at what's going on while the main thread is still stuck.
+                var report = activity.report(startDate: startDate)
+                responded.wait()
+                report.duration =
+                    Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1e9
+                onStall(report)
+            }
+
+            Thread.sleep(forTimeInterval: threshold / 2)
+        }
+    }
+}
+
+// MARK: - Main thread hops
+
+/// Runs `body` on the main thread and waits for it, recording the hop for stall reports.
+///
+/// - parameter site: Describes the caller, e.g. "findAppByPID".
+func syncOnMainThread<T>(_ site: String, _ body: () -> T) -> T {
+    if Thread.current.isMainThread {
+        return body()
+    }
+    let hop = Metrics.shared.activity.beginSyncHop(site)
+    defer { Metrics.shared.activity.endSyncHop(hop) }
+    return DispatchQueue.main.sync(execute: body)
+}
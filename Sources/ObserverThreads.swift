@@ -0,0 +1,156 @@
+import AXSwift
+import Cocoa
+
+// MARK: - ObserverThread
+
+/// A thread with its own run loop, on which accessibility observers deliver their callbacks.
+///
+/// An observer delivers callbacks on the run loop it was created on, so observers are created
+/// inside `sync`.
+final class ObserverThread: Thread {
+    private var runLoop: CFRunLoop!
+    private let started = DispatchSemaphore(value: 0)
+
+    init(name: String) {
+        super.init()
+        self.name = name
+        qualityOfService = .userInteractive
+    }
+
+    /// Starts the thread and waits for its run loop to be ready.
+    override func start() {
+        super.start()
+        started.wait()
+    }
+
+    override func main() {
+        runLoop = CFRunLoopGetCurrent()
+        // A run loop with no sources returns immediately; the port keeps this one running.
+        RunLoop.current.add(NSMachPort(), forMode: .default)
+        started.signal()
+        while !isCancelled {
+            _ = RunLoop.current.run(mode: .default, before: .distantFuture)
+        }
+    }
+
+    /// Stops the run loop. Observers still on the thread stop receiving callbacks.
+    func stop() {
+        cancel()
+        CFRunLoopStop(runLoop)
+    }
+
+    /// Runs `body` on the thread, without waiting for it.
+    func async(_ body: @escaping () -> Void) {
+        CFRunLoopPerformBlock(runLoop, CFRunLoopMode.defaultMode.rawValue, body)
+        CFRunLoopWakeUp(runLoop)
+    }
+
+    /// Runs `body` on the thread and waits for it.
+    ///
+    /// The thread never waits on the main thread, so this is safe to call from there.
+    func sync<T>(_ body: @escaping () throws -> T) throws -> T {
+        if Thread.current == self {
+            return try body()
+        }
+        var result: Result<T, Error>!
+        let done = DispatchSemaphore(value: 0)
+        async {
+            result = Result { try body() }
+            done.signal()
+        }
+        done.wait()
+        return try result.get()
+    }
+}
+
+// MARK: - ObserverThreadPool
+
+/// A fixed set of observer threads that applications are spread across.
+///
+/// A thread per application would cost a thread for every background process with a
+/// window; a small pool keeps one busy application from delaying the others without that cost.
+final class ObserverThreadPool {
+    private let threads: [ObserverThread]
+
+    init(count: Int) {
+        precondition(count > 0)
+        threads = (0..<count).map { ObserverThread(name: "Swindler observer \($0)") }
+        threads.forEach { $0.start() }
+    }
+
+    deinit {
+        threads.forEach { $0.stop() }
+    }
+
+    /// The thread for the application with process identifier `pid`. An application always gets
+    /// the same thread, so its notifications stay in order.
+    func thread(for pid: pid_t) -> ObserverThread {
+        return threads[Int(UInt32(bitPattern: pid) % UInt32(threads.count))]
+    }
+}
+
+// MARK: - NotificationBatcher
+
+/// Hands notifications received on an observer thread to the main thread in batches, in the order
+/// they were received.
+///
+/// A batch is scheduled when the first notification arrives, and takes everything that arrives
+/// before it runs. A notification that repeats the one just before it is dropped, since handling a
+/// notification reads the current state anyway.
+final class NotificationBatcher<Context, UIElement: Equatable> {
+    typealias Handler = (Context, UIElement, AXNotification) -> Void
+    private typealias Entry = (context: Context, element: UIElement, notification: AXNotification)
+
+    private let handler: Handler
+    private let lock = NSLock()
+    private var pending: [Entry] = []
+    private var droppedRepeats_ = 0
+
+    /// - parameter handler: Called on the main thread with each notification.
+    init(_ handler: @escaping Handler) {
+        self.handler = handler
+    }
+
+    /// The number of notifications dropped as repeats.
+    var droppedRepeats: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return droppedRepeats_
+    }
+
+    /// Queues a notification. Called on an observer thread.
+    func enqueue(_ context: Context, _ element: UIElement, _ notification: AXNotification) {
+        lock.lock()
+        if let last = pending.last, last.element == element, last.notification == notification {
+            droppedRepeats_ += 1
+            lock.unlock()
+            return
+        }
+        pending.append((context, element, notification))
+        let isFirst = pending.count == 1
+        lock.unlock()
+
+        if isFirst {
+            DispatchQueue.main.async { self.deliver() }
+        }
+    }
+
+    /// Drops the notifications not delivered yet.
+    func removeAll() {
+        lock.lock()
+        pending = []
+        lock.unlock()
+    }
+
+    private func deliver() {
+        assert(Thread.current.isMainThread)
+        lock.lock()
+        let batch = pending
+        pending = []
+        lock.unlock()
+
+        for entry in batch {
+            handler(entry.context, entry.element, entry.notification)
+        }
+    }
+}
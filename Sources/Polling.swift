@@ -0,0 +1,294 @@
+import Foundation
+import PromiseKit
+
+// MARK: - IPCBudget
+
+/// A limit on the rate of accessibility requests Swindler makes on its own initiative, like polls.
+///
+/// This is a token bucket: it holds up to `burst` requests, and refills at `requestsPerSecond`.
+/// Requests made on behalf of the user, like property reads and writes, are never limited.
+///
+/// Must be used on the main thread.
+public final class IPCBudget {
+    /// The sustained rate of requests allowed.
+    public var requestsPerSecond: Double {
+        didSet { refill() }
+    }
+    /// The most requests that can be made at once after a quiet period.
+    public var burst: Double {
+        didSet { tokens = min(tokens, burst) }
+    }
+
+    /// The number of requests denied so far.
+    public private(set) var deniedRequests = 0
+
+    private var tokens: Double
+    private var lastRefill: Date
+
+    // Overridden by tests.
+    var clock: () -> Date = Date.init
+
+    public init(requestsPerSecond: Double = 20, burst: Double = 40) {
+        self.requestsPerSecond = requestsPerSecond
+        self.burst = burst
+        tokens = burst
+        lastRefill = Date()
+    }
+
+    /// The number of requests that can be made right now.
+    public var available: Double {
+        refill()
+        return tokens
+    }
+
+    /// Takes `count` requests from the budget whether or not they are available, for requests that
+    /// can't wait. The budget may go into debt, which delays later requests.
+    public func forceConsume(_ count: Int) {
+        assert(Thread.current.isMainThread)
+        refill()
+        tokens -= Double(count)
+    }
+
+    /// Takes `count` requests from the budget if they are available. Returns false, and takes
+    /// nothing, if they aren't.
+    public func tryConsume(_ count: Int) -> Bool {
+        assert(Thread.current.isMainThread)
+        refill()
+        guard tokens >= Double(count) else {
+            deniedRequests += count
+            return false
+        }
+        tokens -= Double(count)
+        return true
+    }
+
+    private func refill() {
+        let now = clock()
+        let elapsed = max(0, now.timeIntervalSince(lastRefill))
+        tokens = min(burst, tokens + elapsed * requestsPerSecond)
+        lastRefill = now
+    }
+}
+
+// MARK: - Poll targets
+
+/// The result of polling an application.
+struct PollOutcome {
+    /// The number of accessibility requests made.
+    var requests = 0
+    /// Windows with at least one property that changed since it was last read.
+    var changedWindows = 0
+    /// Changes that no notification was received for.
+    var missedNotifications = 0
+
+    static func + (lhs: PollOutcome, rhs: PollOutcome) -> PollOutcome {
+        return PollOutcome(requests: lhs.requests + rhs.requests,
+                           changedWindows: lhs.changedWindows + rhs.changedWindows,
+                           missedNotifications: lhs.missedNotifications + rhs.missedNotifications)
+    }
+}
+
+/// An application that can be polled.
+protocol PollTarget: AnyObject {
+    var processIdentifier: pid_t! { get }
+    /// The number of requests a poll makes.
+    var pollCost: Int { get }
+    /// Reads the watched attributes of every window, emitting events for any that changed.
+    /// Never fails.
+    func poll(qos: DispatchQoS.QoSClass) -> Promise<PollOutcome>
+}
+
+// MARK: - PollingSupervisor
+
+/// Falls back to polling for applications that don't reliably send accessibility notifications.
+///
+/// Polling is off by default; set `isEnabled` to turn it on. While it is on, every application is
+/// audited by polling it once every `auditInterval`. If an audit finds
+/// changes that no notification was received for, the application is marked unreliable and polled
+/// regularly from then on. Polling starts at `minimumInterval`, backs off towards
+/// `maximumInterval` while nothing changes, and speeds up again when something does. An
+/// application that goes `recoveryInterval` without a missed notification is trusted again.
+///
+/// Polls draw from `ipcBudget`; a poll that doesn't fit is postponed.
+///
+/// Separately, when an application becomes frontmost, its windows are prefetched: read once at
+/// high priority, so that anything that changed while the application was in the background is up
+/// to date before the user interacts with it.
+///
+/// Must be used on the main thread.
+public final class PollingSupervisor {
+    /// Whether to audit and poll applications at all. Defaults to false, because audits make
+    /// requests to every running application, including ones with reliable notifications.
+    public var isEnabled = false {
+        didSet { schedule() }
+    }
+    /// How often every application is polled to check that its notifications are reliable.
+    public var auditInterval: TimeInterval = 30 {
+        didSet { schedule() }
+    }
+    /// The fastest an unreliable application is polled.
+    public var minimumInterval: TimeInterval = 0.5
+    /// The slowest an unreliable application is polled.
+    public var maximumInterval: TimeInterval = 5
+    /// The number of missed notifications after which an application is considered unreliable.
+    public var missedNotificationThreshold = 2
+    /// How long an unreliable application must go without missing a notification to be trusted
+    /// again.
+    public var recoveryInterval: TimeInterval = 300
+
+    /// Whether to prefetch the windows of an application when it becomes frontmost. Defaults to
+    /// true.
+    public var isPrefetchEnabled = true
+    /// The number of windows found to be out of date by prefetching so far.
+    public private(set) var prefetchedWindowChanges = 0
+
+    /// Limits the requests made by polling and prefetching.
+    public let ipcBudget = IPCBudget()
+
+    private struct TargetState {
+        var isUnreliable = false
+        var isPinned = false
+        var missedNotifications = 0
+        var lastMissDate: Date?
+        var interval: TimeInterval
+        var nextPollDate: Date
+        var isPolling = false
+    }
+    private var states: [pid_t: TargetState] = [:]
+    private let targets: () -> [PollTarget]
+    private var generation = 0
+
+    // Overridden by tests.
+    var clock: () -> Date = Date.init
+
+    init(targets: @escaping () -> [PollTarget]) {
+        self.targets = targets
+    }
+
+    /// The process identifiers of applications currently being polled.
+    public var unreliableApplications: [pid_t] {
+        return states.filter { $0.value.isUnreliable }.map { $0.key }
+    }
+
+    /// Polls the application with `pid` regularly, whether or not its notifications are reliable.
+    public func markUnreliable(_ pid: pid_t) {
+        assert(Thread.current.isMainThread)
+        var state = self.state(for: pid, now: clock())
+        state.isUnreliable = true
+        state.isPinned = true
+        state.interval = minimumInterval
+        state.nextPollDate = clock()
+        states[pid] = state
+        schedule()
+    }
+
+    /// Reads every window of `target` at high priority. Prefetches always run, but still draw from
+    /// `ipcBudget`, so that background polling yields to them.
+    ///
+    /// Changes found by a prefetch don't count as missed notifications, since applications in the
+    /// background legitimately change their windows without the user seeing. As with polls, a value
+    /// read by a prefetch is dropped if a newer one was stored while it was being read.
+    func prefetch(_ target: PollTarget) {
+        assert(Thread.current.isMainThread)
+        guard isPrefetchEnabled, target.pollCost > 0 else { return }
+        ipcBudget.forceConsume(target.pollCost)
+        target.poll(qos: .userInitiated).done { outcome in
+            guard outcome.changedWindows > 0 else { return }
+            self.prefetchedWindowChanges += outcome.changedWindows
+            log.debug("Prefetch updated \(outcome.changedWindows) windows")
+        }.catch { error in
+            log.debug("Prefetch failed: \(error)")
+        }
+    }
+
+    /// Forgets an application that terminated.
+    func remove(_ pid: pid_t) {
+        states[pid] = nil
+    }
+
+    /// Polls every application that is due, then schedules the next check.
+    func pollDueTargets() {
+        assert(Thread.current.isMainThread)
+        guard isEnabled else { return }
+        let now = clock()
+        for target in targets() {
+            guard let pid = target.processIdentifier else { continue }
+            var state = self.state(for: pid, now: now)
+            if states[pid] == nil {
+                states[pid] = state
+            }
+            guard !state.isPolling && state.nextPollDate <= now else { continue }
+            guard ipcBudget.tryConsume(target.pollCost) else {
+                log.debug("Postponing poll of pid \(pid); over the IPC budget")
+                state.nextPollDate = now.addingTimeInterval(minimumInterval)
+                states[pid] = state
+                continue
+            }
+            state.isPolling = true
+            states[pid] = state
+            target.poll(qos: .utility).done { outcome in
+                self.record(outcome, for: pid)
+            }.catch { error in
+                log.debug("Polling pid \(pid) failed: \(error)")
+            }
+        }
+        schedule()
+    }
+
+    // Applications are audited as soon as they are first seen.
+    private func state(for pid: pid_t, now: Date) -> TargetState {
+        return states[pid] ?? TargetState(interval: auditInterval, nextPollDate: now)
+    }
+
+    private func record(_ outcome: PollOutcome, for pid: pid_t) {
+        // The application may have terminated while the poll was running.
+        guard var state = states[pid] else { return }
+        let now = clock()
+        state.isPolling = false
+
+        if outcome.missedNotifications > 0 {
+            state.missedNotifications += outcome.missedNotifications
+            state.lastMissDate = now
+            if !state.isUnreliable && state.missedNotifications >= missedNotificationThreshold {
+                log.info("Polling pid \(pid); it missed \(state.missedNotifications) notifications")
+                state.isUnreliable = true
+            }
+        } else if state.isUnreliable && !state.isPinned,
+                  let lastMiss = state.lastMissDate,
+                  now.timeIntervalSince(lastMiss) >= recoveryInterval {
+            log.info("No longer polling pid \(pid)")
+            state.isUnreliable = false
+            state.missedNotifications = 0
+        }
+
+        if !state.isUnreliable {
+            state.interval = auditInterval
+        } else if outcome.changedWindows > 0 {
+            state.interval = minimumInterval
+        } else {
+            state.interval = min(maximumInterval, max(minimumInterval, state.interval * 2))
+        }
+        state.nextPollDate = now.addingTimeInterval(state.interval)
+        states[pid] = state
+        schedule()
+    }
+
+    /// Schedules `pollDueTargets` for the next time an application is due.
+    func schedule() {
+        generation += 1
+        guard isEnabled else { return }
+        let scheduled = generation
+        let now = clock()
+        let next = states.values.filter { !$0.isPolling }.map { $0.nextPollDate }.min()
+        let delay = min(auditInterval, max(0, next.map { $0.timeIntervalSince(now) } ?? .infinity))
+        DispatchQueue.main.asyncAfter(deadline: .now() + delay) { [weak self] in
+            guard let self = self, self.generation == scheduled else { return }
+            self.pollDueTargets()
+        }
+    }
+}
+
+extension State {
+    /// Controls polling of applications whose accessibility notifications are unreliable.
+    public var polling: PollingSupervisor { return delegate.polling }
+}
@@ -37,6 +37,13 @@ protocol PropertyDelegate {
     /// resolves.
     /// You can call `refresh()` on the property, however, as it will wait for this to resolve.
     func initialize() -> Promise<T?>
+
+    /// Extracts the property value from attributes that were read in bulk, as with
+    /// `getMultipleAttributes`. Returns `nil` if the value is not among them.
+    func readValue(from attributes: [AXSwift.Attribute: Any]) -> T?
+}
+extension PropertyDelegate {
+    func readValue(from attributes: [AXSwift.Attribute: Any]) -> T? { return nil }
 }
 
 /// Specifies an error that occurred during a property read or write.
@@ -134,16 +141,20 @@ public class Property<TypeSpec: PropertyTypeSpec> {
     // The backing store
     fileprivate var value_: PropertyType!
     // Implementation of how to read and write the value
-    var delegate_: PropertyDelegateThunk<TypeSpec>
+    let delegate_: PropertyDelegateBox<NonOptionalType>
     // Where events go
-    fileprivate var notifier: PropertyNotifierThunk<TypeSpec>
+    fileprivate var notifier: PropertyNotifierBox<PropertyType>
 
-    // Only do one request on a given property at a time. This ensures that events get emitted from
-    // the right operation.
-    fileprivate let requestLock = NSLock()
-    // Since the backing store can be updated on another thread, we need to lock it.
-    // This lock MUST NOT be held during a slow call. Only hold it as long as necessary.
-    fileprivate let backingStoreLock = NSLock()
+    // May be shared with the other properties of the same object.
+    let locks: PropertyLocks
+
+    // Set if the value is only read when first needed.
+    private let lazyInit: LazyInitialization<PropertyType>?
+
+    // Incremented every time the backing store is written, so that a value read in bulk can be
+    // discarded if something newer was stored after the read began. Protected by the backing store
+    // lock.
+    private var changeSequence_ = 0
 
     // Exposed for testing only.
     var backgroundQueue: DispatchQueue = DispatchQueue.global(qos: .default)
@@ -152,15 +163,18 @@ public class Property<TypeSpec: PropertyTypeSpec> {
     // resolves.
     fileprivate(set) var initialized: Promise<Void>!
     // Property definer can access the delegate they provided here
-    fileprivate(set) var delegate: Any
+    var delegate: Any { return delegate_.base }
 
     init<Impl: PropertyDelegate, Notifier: PropertyNotifier>(
         _ delegate: Impl,
-        notifier: Notifier
+        notifier: Notifier,
+        locks: PropertyLocks = PropertyLocks(),
+        lazily lazyInit: LazyInitialization<PropertyType>? = nil
     ) where Impl.T == NonOptionalType {
-        self.notifier = PropertyNotifierThunk(notifier)
-        self.delegate = delegate
-        delegate_ = PropertyDelegateThunk(delegate)
+        self.notifier = WeakPropertyNotifierBox(notifier)
+        self.locks = locks
+        self.lazyInit = lazyInit
+        delegate_ = ConcretePropertyDelegateBox(delegate)
 
         self.initialized = initialize(delegate)
     }
@@ -173,22 +187,29 @@ public class Property<TypeSpec: PropertyTypeSpec> {
         _ delegate: Impl,
         withEvent: Event.Type,
         receivingObject: Object.Type,
-        notifier: Notifier
+        notifier: Notifier,
+        locks: PropertyLocks = PropertyLocks(),
+        lazily lazyInit: LazyInitialization<PropertyType>? = nil
     ) where Impl.T == NonOptionalType,
             Event.PropertyType == PropertyType,
             Event.Object == Object,
             Notifier.Object == Object {
-        self.init(delegate, notifier: notifier)
-        self.notifier = PropertyNotifierThunk(notifier,
-                                              withEvent: Event.self,
-                                              receivingObject: Object.self)
+        self.init(delegate, notifier: notifier, locks: locks, lazily: lazyInit)
+        self.notifier = EventPropertyNotifierBox<Notifier, Event>(notifier)
     }
 
     func initialize<Impl: PropertyDelegate>(_ delegate: Impl) -> Promise<Void>
     where Impl.T == NonOptionalType {
         let (promise, seal) = Promise<Void>.pending()
         delegate.initialize().done { value in
-            self.value_ = try TypeSpec.toPropertyType(value)
+            let initialValue = try TypeSpec.toPropertyType(value)
+            self.locks.backingStore.lock()
+            // A lazy property may have been read already.
+            if self.value_ == nil {
+                self.value_ = initialValue
+                self.changeSequence_ += 1
+            }
+            self.locks.backingStore.unlock()
             seal.fulfill(())
         }.catch { error in
             self.handleError(error)
@@ -199,13 +220,45 @@ public class Property<TypeSpec: PropertyTypeSpec> {
 
     /// The value of the property.
     public var value: PropertyType {
+        DependencyTracker.shared.recordRead(.property(ObjectIdentifier(self)))
         return getValue()
     }
 
     func getValue() -> PropertyType {
-        backingStoreLock.lock()
-        defer { backingStoreLock.unlock() }
-        return value_
+        materializeIfNeeded()
+        locks.backingStore.lock()
+        defer { locks.backingStore.unlock() }
+        return value_ ?? lazyInit!.placeholder
+    }
+
+    /// For a lazy property, reads the value on this thread if it hasn't been read yet, or waits for
+    /// the read in flight. If the attributes can't be read, the value is the placeholder, and
+    /// later calls don't block: they retry the read in the background, with backoff, until it
+    /// succeeds. If the attributes don't include the property, it stays the placeholder.
+    private func materializeIfNeeded() {
+        guard let lazyInit = lazyInit else { return }
+        locks.backingStore.lock()
+        let needed = value_ == nil
+        locks.backingStore.unlock()
+        guard needed else { return }
+
+        guard let attributes = try? lazyInit.attributes.get() else {
+            lazyInit.attributes.retry()?.done { _ in
+                self.materializeIfNeeded()
+                DependencyTracker.shared.changed(.property(ObjectIdentifier(self)))
+            }.catch { error in
+                log.debug("Lazy property (of type \(PropertyType.self)) couldn't be read: \(error)")
+            }
+            return
+        }
+        let value = (try? TypeSpec.toPropertyType(delegate_.readValue(from: attributes)))
+            ?? lazyInit.placeholder
+        locks.backingStore.lock()
+        if value_ == nil {
+            value_ = value
+            changeSequence_ += 1
+        }
+        locks.backingStore.unlock()
     }
 
     /// Forces the value of the property to refresh.
@@ -219,12 +272,24 @@ public class Property<TypeSpec: PropertyTypeSpec> {
     /// - throws: `PropertyError` (via Promise)
     @discardableResult
     public func refresh() -> Promise<PropertyType> {
+        // A lazy property that nobody has read has no old value to compare with, so reading it
+        // for the first time is the refresh.
+        if let lazyInit = lazyInit, let read = lazyInit.attributes.request() {
+            return read.then { _ in self.initialized }.map { self.getValue() }.tap { result in
+                if case .rejected(let error) = result {
+                    self.handleError(error)
+                }
+            }
+        }
+
         // Allow queueing up a refresh before initialization is complete, which means "assume the
         // value you will be initialized with is going to be stale". This is useful if an event is
         // received before fully initializing.
+        let request = locks.activity?.queued(refresh: true)
         return initialized.map(on: backgroundQueue) { () -> (PropertyType, PropertyType) in
-            self.requestLock.lock()
-            defer { self.requestLock.unlock() }
+            self.locks.request.lock()
+            defer { self.locks.request.unlock() }
+            request?.dequeued()
 
             let actual = try TypeSpec.toPropertyType(self.delegate_.readValue())
             let oldValue = self.updateBackingStore(actual)
@@ -233,23 +298,91 @@ public class Property<TypeSpec: PropertyTypeSpec> {
         }.map { (oldValue, actual) -> PropertyType in
             // Back on main thread.
             if !TypeSpec.equal(oldValue, actual) {
-                self.notifier.notify?(true, oldValue, actual)
+                DependencyTracker.shared.changed(.property(ObjectIdentifier(self)))
+                self.notifier.notify(external: true, oldValue: oldValue, newValue: actual)
             }
             return actual
         }.tap { result in
+            request?.completed()
             if case .rejected(let error) = result {
                 self.handleError(error)
             }
         }
     }
 
+    /// Identifies the value currently stored. Capture it before reading attributes in bulk, and
+    /// pass it to `update(fromPolled:ifUnchangedSince:)`.
+    var changeSequence: Int {
+        locks.backingStore.lock()
+        defer { locks.backingStore.unlock() }
+        return changeSequence_
+    }
+
+    /// Updates the property from attributes that were read in bulk by polling, and emits an
+    /// (external) event if the value changed. Returns whether it changed.
+    ///
+    /// The update is skipped if the property isn't initialized, if a request is in flight that
+    /// will deliver a fresher value, or if a value was stored since `sequence` was captured (from
+    /// `changeSequence`, before the attributes were read), since that value may be fresher.
+    func update(fromPolled attributes: [AXSwift.Attribute: Any],
+                ifUnchangedSince sequence: Int) -> Bool {
+        assert(Thread.current.isMainThread)
+        guard initialized.isFulfilled,
+              let polled = delegate_.readValue(from: attributes),
+              let actual = try? TypeSpec.toPropertyType(polled),
+              locks.request.try() else {
+            return false
+        }
+        locks.backingStore.lock()
+        let isCurrent = changeSequence_ == sequence
+        let oldValue: PropertyType = value_
+        if isCurrent {
+            value_ = actual
+            changeSequence_ += 1
+        }
+        locks.backingStore.unlock()
+        locks.request.unlock()
+
+        guard isCurrent else { return false }
+        guard !TypeSpec.equal(oldValue, actual) else { return false }
+        DependencyTracker.shared.changed(.property(ObjectIdentifier(self)))
+        notifier.notify(external: true, oldValue: oldValue, newValue: actual)
+        return true
+    }
+
+    /// Stores a value read back in bulk after a write made outside of `set`, as by
+    /// `Window.apply(changes:)`. Must be called on a background thread with `locks.request` held.
+    ///
+    /// - returns: The old and new values, or `nil` if the attributes don't include the property.
+    func storeReadback(
+        from attributes: [AXSwift.Attribute: Any]
+    ) throws -> (oldValue: PropertyType, newValue: PropertyType)? {
+        materializeIfNeeded()
+        guard let value = delegate_.readValue(from: attributes) else { return nil }
+        let actual = try TypeSpec.toPropertyType(value)
+        return (updateBackingStore(actual), actual)
+    }
+
+    /// Emits the event for a change stored by `storeReadback(from:)`. As with `set`, the event is
+    /// internal if the new value is the one that was written.
+    func notifyReadback(oldValue: PropertyType, newValue: PropertyType, desired: NonOptionalType?) {
+        assert(Thread.current.isMainThread)
+        guard !TypeSpec.equal(oldValue, newValue) else { return }
+        let external = desired.flatMap { try? TypeSpec.toPropertyType($0) }
+            .map { !TypeSpec.equal(newValue, $0) } ?? true
+        DependencyTracker.shared.changed(.property(ObjectIdentifier(self)))
+        notifier.notify(external: external, oldValue: oldValue, newValue: newValue)
+    }
+
     /// Synchronously updates the backing store and returns the old value.
     fileprivate func updateBackingStore(_ newValue: PropertyType) -> PropertyType {
-        backingStoreLock.lock()
-        defer { self.backingStoreLock.unlock() }
+        locks.backingStore.lock()
+        defer { self.locks.backingStore.unlock() }
 
-        let oldValue = value_
+        // A lazy property whose attributes couldn't be read yet starts from the placeholder.
+        let oldValue = value_ ?? lazyInit?.placeholder
         value_ = newValue
+        changeSequence_ += 1
 
         return oldValue!
     }
@@ -270,14 +403,21 @@ public class Property<TypeSpec: PropertyTypeSpec> {
 public class WriteableProperty<TypeSpec: PropertyTypeSpec>: Property<TypeSpec> {
     // Due to a Swift bug I have to override this.
     override init<Impl: PropertyDelegate, Notifier: PropertyNotifier>(
-        _ delegate: Impl, notifier: Notifier
+        _ delegate: Impl,
+        notifier: Notifier,
+        locks: PropertyLocks = PropertyLocks(),
+        lazily lazyInit: LazyInitialization<PropertyType>? = nil
     ) where Impl.T == NonOptionalType {
-        super.init(delegate, notifier: notifier)
+        super.init(delegate, notifier: notifier, locks: locks, lazily: lazyInit)
     }
 
-    /// The value of the property. Reading is instant and synchronous, but writing is asynchronous
-    /// and the value will not be updated until the write is complete. Use `set` to retrieve a
-    /// promise.
+    /// The value of the property. Reading is synchronous and returns the cached value, except for
+    /// the first read of a lazily initialized window property (see
+    /// `Configuration.lazyWindowProperties`), which blocks on a request to the application. If that
+    /// request fails, reads return a placeholder while the request is retried in the background.
+    ///
+    /// Writing is asynchronous and the value will not be updated until the write is complete. Use
+    /// `set` to retrieve a promise.
     public override var value: PropertyType {
         get {
             return super.value
@@ -308,11 +448,15 @@ public class WriteableProperty<TypeSpec: PropertyTypeSpec>: Property<TypeSpec> {
     }
 
     final func mutateWith(f: @escaping () throws -> (NonOptionalType)) -> Promise<PropertyType> {
+        let request = locks.activity?.queued(refresh: false)
         return Promise<Void>.value(()).map(on: backgroundQueue) {
             () throws -> (PropertyType, PropertyType, PropertyType) in
 
-            self.requestLock.lock()
-            defer { self.requestLock.unlock() }
+            // The old value is needed to tell whether the write changed anything.
+            self.materializeIfNeeded()
+            self.locks.request.lock()
+            defer { self.locks.request.unlock() }
+            request?.dequeued()
 
             // Write, then read back the value to see what actually changed.
             let newValue = try f()
@@ -336,10 +480,12 @@ public class WriteableProperty<TypeSpec: PropertyTypeSpec>: Property<TypeSpec> {
                 // That something could be the user, the application, or the operating system.
                 // Therefore we mark the event as external.
                 let external = !TypeSpec.equal(actual, desired)
-                self.notifier.notify?(external, oldValue, actual)
+                DependencyTracker.shared.changed(.property(ObjectIdentifier(self)))
+                self.notifier.notify(external: external, oldValue: oldValue, newValue: actual)
             }
             return actual
         }.tap { result in
+            request?.completed()
             if case .rejected(let error) = result {
                 self.handleError(error)
             }
@@ -347,51 +493,91 @@ public class WriteableProperty<TypeSpec: PropertyTypeSpec>: Property<TypeSpec> {
     }
 }
 
-// Because Swift doesn't have generic protocols, we have to use these ugly thunks to simulate them.
-// Hopefully this will be addressed in a future Swift release.
+/// How a lazy property gets its value: from `attributes`, which are read when any of the
+/// properties sharing them is first read, refreshed, written, or explicitly requested. If they
+/// can't be read, the value is `placeholder`, and they are read again the next time one of those
+/// happens.
+///
+/// Until a read succeeds, the property's `initialized` promise is pending.
+struct LazyInitialization<PropertyType> {
+    let attributes: LazyAttributes
+    let placeholder: PropertyType
+}
+
+/// The locks used by a `Property`.
+///
+/// Each lock is an object with its own mutex, so objects with several properties (like windows)
+/// share one set between all of them instead of allocating a pair per property.
+final class PropertyLocks {
+    // Only do one request on a given property at a time. This ensures that events get emitted from
+    // the right operation.
+    let request = NSLock()
+    // Since the backing store can be updated on another thread, we need to lock it.
+    // This lock MUST NOT be held during a slow call. Only hold it as long as necessary.
+    let backingStore = NSLock()
+
+    // Where reads and writes are counted for `State.health()`, if the properties belong to a
+    // process. Shared for the same reason as the locks.
+    let activity: ProcessActivity?
+
+    init(activity: ProcessActivity? = nil) {
+        self.activity = activity
+    }
+}
+
+// Because Swift doesn't have generic protocols, we erase the concrete delegate and notifier types
+// with a class hierarchy: the base class declares the interface, and a generic subclass holds the
+// concrete implementation. Each call is still dynamic dispatch (a vtable call rather than a closure
+// call), but there are no closure contexts to allocate or retain, and the subclass calls the
+// implementation directly. This is type erasure, not specialization of Property itself.
+
+class PropertyDelegateBox<T: Equatable> {
+    var base: Any { fatalError("abstract") }
+    func readValue() throws -> T? { fatalError("abstract") }
+    func writeValue(_ newValue: T) throws { fatalError("abstract") }
+    func readValue(from attributes: [AXSwift.Attribute: Any]) -> T? { fatalError("abstract") }
+}
 
-struct PropertyDelegateThunk<TypeSpec: PropertyTypeSpec> {
-    // Use non-optional type as base so we don't have a double optional, and preserve the Equatable
-    // info.
-    typealias PropertyType = TypeSpec.NonOptionalType
+private final class ConcretePropertyDelegateBox<Impl: PropertyDelegate>:
+    PropertyDelegateBox<Impl.T> {
+    let impl: Impl
 
-    init<Impl: PropertyDelegate>(_ impl: Impl) where Impl.T == PropertyType {
-        writeValue_ = impl.writeValue
-        readValue_ = impl.readValue
+    init(_ impl: Impl) {
+        self.impl = impl
     }
 
-    let writeValue_: (_ newValue: PropertyType) throws -> Void
-    let readValue_: () throws -> PropertyType?
+    override var base: Any { return impl }
+    override func readValue() throws -> Impl.T? { return try impl.readValue() }
+    override func writeValue(_ newValue: Impl.T) throws { try impl.writeValue(newValue) }
+    override func readValue(from attributes: [AXSwift.Attribute: Any]) -> Impl.T? {
+        return impl.readValue(from: attributes)
+    }
+}
 
-    func writeValue(_ newValue: PropertyType) throws { try writeValue_(newValue) }
-    func readValue() throws -> PropertyType? { return try readValue_() }
+/// Does nothing on `notify`; used by properties without an event.
+private class PropertyNotifierBox<PropertyType> {
+    func notify(external: Bool, oldValue: PropertyType, newValue: PropertyType) {}
+    func notifyInvalid() {}
 }
 
-private struct PropertyNotifierThunk<TypeSpec: PropertyTypeSpec> {
-    typealias PropertyType = TypeSpec.PropertyType
-
-    // Will be nil if not initialized with an event type.
-    let notify: Optional<
-        (_ external: Bool, _ oldValue: PropertyType, _ newValue: PropertyType) -> Void
-    >
-    let notifyInvalid: () -> Void
-
-    init<Notifier: PropertyNotifier, Event: PropertyEventType, Object>(
-        _ wrapped: Notifier, withEvent: Event.Type, receivingObject: Object.Type
-    ) where Event.PropertyType == PropertyType, Notifier.Object == Object, Event.Object == Object {
-        weak var wrappedNotifier = wrapped
-        self.notifyInvalid = { wrappedNotifier?.notifyInvalid() }
-        self.notify = { (external: Bool, oldValue: PropertyType, newValue: PropertyType) in
-            wrappedNotifier?.notify(Event.self,
-                                    external: external,
-                                    oldValue: oldValue,
-                                    newValue: newValue)
-        }
+private class WeakPropertyNotifierBox<Notifier: PropertyNotifier, PropertyType>:
+    PropertyNotifierBox<PropertyType> {
+    weak var wrapped: Notifier?
+
+    init(_ wrapped: Notifier) {
+        self.wrapped = wrapped
     }
 
-    init<Notifier: PropertyNotifier>(_ wrapped: Notifier) {
-        weak var wrappedNotifier = wrapped
-        self.notifyInvalid = { wrappedNotifier?.notifyInvalid() }
-        self.notify = nil
+    override func notifyInvalid() {
+        wrapped?.notifyInvalid()
+    }
+}
+
+private final class EventPropertyNotifierBox<Notifier: PropertyNotifier, Event: PropertyEventType>:
+    WeakPropertyNotifierBox<Notifier, Event.PropertyType> where Notifier.Object == Event.Object {
+    override func notify(external: Bool,
+                         oldValue: Event.PropertyType,
+                         newValue: Event.PropertyType) {
+        wrapped?.notify(Event.self, external: external, oldValue: oldValue, newValue: newValue)
     }
 }
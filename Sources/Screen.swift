@@ -53,6 +53,21 @@ func calculateMaxY(_ screens: [ScreenDelegate]) -> CGFloat {
     return maxY
 }
 
+/// The index of the screen in `screens` that most of `frame` is on, or nil if `frame` is entirely
+/// off-screen.
+func indexOfScreen(containingMostOf frame: CGRect, in screens: [ScreenDelegate]) -> Int? {
+    var best: (index: Int, area: CGFloat)?
+    for (index, screen) in screens.enumerated() {
+        let intersection = screen.frame.intersection(frame)
+        guard !intersection.isNull else { continue }
+        let area = intersection.width * intersection.height
+        if best == nil || area > best!.area {
+            best = (index, area)
+        }
+    }
+    return best?.index
+}
+
 protocol ScreenDelegate: AnyObject, CustomDebugStringConvertible {
     var frame: CGRect { get }
     var applicationFrame: CGRect { get }
@@ -261,7 +276,7 @@ final class OSXScreenDelegate<NSScreenT: NSScreenType>: ScreenDelegate {
 extension OSXScreenDelegate {
 }
 
-private func numberForScreen<NSScreenT: NSScreenType>(_ nsScreen: NSScreenT) -> CGDirectDisplayID {
+func numberForScreen<NSScreenT: NSScreenType>(_ nsScreen: NSScreenT) -> CGDirectDisplayID {
     // Get the direct display ID. This is documented to always exist.
     let screenNumber = nsScreen.deviceDescription[NSDeviceDescriptionKey(kNSScreenNumber)]!
     return CGDirectDisplayID((screenNumber as! NSNumber).intValue)
@@ -0,0 +1,516 @@
+import Cocoa
+import PromiseKit
+
+// MARK: - Space
+
+/// A space, or virtual desktop.
+///
+/// In Swindler, a space corresponds to only one screen, as if "Displays have separate Spaces" were
+/// turned on. Spaces are known once the user has visited them since Swindler was started.
+public final class Space: Equatable {
+    internal let delegate: SpaceDelegate
+    internal init(delegate: SpaceDelegate) {
+        self.delegate = delegate
+    }
+
+    /// Identifies the space while Swindler is running.
+    public var id: Int { return delegate.id }
+
+    /// The screen the space was seen on. `nil` if that screen has since been removed.
+    public var screen: Screen? { return delegate.screen.map { Screen(delegate: $0) } }
+
+    /// Whether the space is currently visible on its screen.
+    public var isVisible: Bool {
+        DependencyTracker.shared.recordRead(.collection(.spaces))
+        return delegate.isVisible
+    }
+
+    /// The known windows on this space, not counting windows on all spaces. More windows may exist
+    /// if new windows were created on it since the user last visited it.
+    public var knownWindows: [Window] {
+        DependencyTracker.shared.recordRead(.collection(.spaces))
+        DependencyTracker.shared.recordRead(.collection(.windows))
+        return delegate.windows.values.compactMap { Window(delegate: $0) }
+    }
+
+    /// The known windows on this space that are visible. Empty if the space is not visible.
+    public var visibleWindows: [Window] {
+        DependencyTracker.shared.recordRead(.collection(.visibleWindows))
+        guard delegate.isVisible, let index = delegate.stateDelegate?.visibleWindows else {
+            return []
+        }
+        return delegate.windows.values.filter { index.contains($0) }.compactMap {
+            Window(delegate: $0)
+        }
+    }
+}
+public func ==(lhs: Space, rhs: Space) -> Bool {
+    return lhs.delegate === rhs.delegate
+}
+
+extension Space: CustomStringConvertible {
+    public var description: String {
+        return "Space(id: \(id))"
+    }
+}
+
+/// A space Swindler has seen, and the windows that were placed on it. Owned by `SpaceTracker`.
+final class SpaceDelegate {
+    let id: Int
+    private(set) weak var screen: ScreenDelegate?
+    fileprivate(set) var isVisible = false
+    fileprivate(set) var windows: [ObjectIdentifier: WindowDelegate] = [:]
+    fileprivate(set) weak var stateDelegate: StateDelegate?
+
+    fileprivate init(id: Int, screen: ScreenDelegate, stateDelegate: StateDelegate?) {
+        self.id = id
+        self.screen = screen
+        self.stateDelegate = stateDelegate
+    }
+}
+
+// MARK: - SpaceObserver
+
+/// Reports which space is visible on each screen.
+protocol SpaceObserver: AnyObject {
+    /// The ID of the space visible on each screen, in the order of `SystemScreenDelegate.screens`.
+    func currentSpaceIDs() -> [Int]
+
+    /// Calls `handler` with the new IDs whenever the visible spaces change.
+    func onSpaceChanged(_ handler: @escaping ([Int]) -> Void)
+}
+
+/// Identifies spaces without private APIs, by leaving an invisible window on each space the first
+/// time it is seen. The ID of a space is the window number of its tracking window. The windows are
+/// closed when the observer is released.
+final class OSXSpaceObserver: SpaceObserver {
+    private var trackingWindows: [NSWindow] = []
+    private var handler: (([Int]) -> Void)?
+    private var notificationObserver: NSObjectProtocol?
+
+    init() {
+        let sharedWorkspace = NSWorkspace.shared
+        notificationObserver = sharedWorkspace.notificationCenter.addObserver(
+            forName: NSWorkspace.activeSpaceDidChangeNotification,
+            object: sharedWorkspace,
+            queue: OperationQueue.main
+        ) { [weak self] _ in
+            guard let self = self else { return }
+            self.handler?(self.currentSpaceIDs())
+        }
+    }
+
+    deinit {
+        if let notificationObserver = notificationObserver {
+            NSWorkspace.shared.notificationCenter.removeObserver(notificationObserver)
+        }
+        trackingWindows.forEach { $0.close() }
+    }
+
+    func onSpaceChanged(_ handler: @escaping ([Int]) -> Void) {
+        self.handler = handler
+    }
+
+    func currentSpaceIDs() -> [Int] {
+        assert(Thread.current.isMainThread)
+        return NSScreen.screens.map { screen in
+            let displayID = numberForScreen(screen)
+            let existing = trackingWindows.first { window in
+                window.isOnActiveSpace && window.screen.map { numberForScreen($0) } == displayID
+            }
+            if let window = existing {
+                return window.windowNumber
+            }
+            let window = makeTrackingWindow(on: screen)
+            trackingWindows.append(window)
+            return window.windowNumber
+        }
+    }
+
+    private func makeTrackingWindow(on screen: NSScreen) -> NSWindow {
+        let window = NSWindow(
+            contentRect: CGRect(x: screen.frame.midX, y: screen.frame.midY, width: 1, height: 1),
+            styleMask: .borderless,
+            backing: .buffered,
+            defer: false)
+        window.isReleasedWhenClosed = false
+        window.alphaValue = 0
+        window.hasShadow = false
+        window.ignoresMouseEvents = true
+        window.collectionBehavior = [.ignoresCycle]
+        // A window only belongs to a space once it is ordered in.
+        window.orderFrontRegardless()
+        return window
+    }
+}
+
+// MARK: - SpaceTracker
+
+/// Keeps track of which space each window is on, and which spaces are visible.
+///
+/// A window is placed on the space visible on its screen when it is created or first seen, and
+/// follows its screen's visible space when it is moved to another screen. Switching to a known
+/// space only moves that space's windows in and out of view.
+///
+/// The accessibility API only lists windows on visible spaces, so when a space is seen for the
+/// first time, every application's window list is read again to discover the windows on it.
+/// These reads draw from the polling `IPCBudget` and are spread out in batches of
+/// `discoveryBatchSize`. A known window that shows up in a list while its space is not visible is
+/// on all spaces.
+///
+/// Lives on the main thread, like `EventNotifier`.
+final class SpaceTracker {
+    /// The most applications to read the window list of at once when discovering windows.
+    var discoveryBatchSize = 4
+    /// How long to wait between discovery batches.
+    var discoveryInterval: TimeInterval = 0.05
+
+    private enum Placement {
+        case space(SpaceDelegate)
+        case allSpaces
+        // Found while the visible spaces changed, so its space isn't known yet. The application
+        // with this process ID is discovered again on the next space switch.
+        case unknown(pid_t)
+    }
+
+    /// Spaces in the order they were first seen.
+    private(set) var knownSpaces: [SpaceDelegate] = []
+    /// The space visible on each screen, in the order of `SystemScreenDelegate.screens`.
+    private(set) var currentSpaces: [SpaceDelegate] = []
+
+    private var spacesByID: [Int: SpaceDelegate] = [:]
+    private var placements: [ObjectIdentifier: Placement] = [:]
+
+    private var pendingDiscovery: [pid_t] = []
+    private var isDiscoveryScheduled = false
+    /// The number of windows found by discovery so far.
+    private(set) var discoveredWindowCount = 0
+
+    private let observer: SpaceObserver
+    private weak var notifier: EventNotifier?
+    private weak var stateDelegate: StateDelegate?
+    private var isStarted = false
+
+    init(notifier: EventNotifier, observer: SpaceObserver, stateDelegate: StateDelegate) {
+        self.notifier = notifier
+        self.observer = observer
+        self.stateDelegate = stateDelegate
+    }
+
+    /// Records the visible spaces and places every known window on them. Call once the state is
+    /// initialized; the windows known then are the ones on the visible spaces.
+    func start() {
+        assert(Thread.current.isMainThread)
+        guard !isStarted, let notifier = notifier else { return }
+        isStarted = true
+
+        notifier.on(label: "SpaceTracker") { [weak self] (event: WindowCreatedEvent) in
+            self?.place(event.window.delegate)
+        }
+        notifier.on(label: "SpaceTracker") { [weak self] (event: WindowDestroyedEvent) in
+            self?.forget(event.window.delegate)
+        }
+        notifier.on(label: "SpaceTracker") { [weak self] (event: WindowFrameChangedEvent) in
+            self?.windowMoved(event.window.delegate)
+        }
+        notifier.on(label: "SpaceTracker") { [weak self] (event: ApplicationLaunchedEvent) in
+            event.application.delegate.forEachWindowDelegate { self?.place($0) }
+        }
+        notifier.on(label: "SpaceTracker") { [weak self] (event: ApplicationTerminatedEvent) in
+            event.application.delegate.forEachWindowDelegate { self?.forget($0) }
+        }
+        notifier.on(label: "SpaceTracker") { [weak self] (_: ScreenLayoutChangedEvent) in
+            guard let self = self else { return }
+            self.spacesChanged(self.observer.currentSpaceIDs())
+        }
+        observer.onSpaceChanged { [weak self] ids in
+            self?.spacesChanged(ids)
+        }
+
+        // Windows on the first visible spaces were all listed during initialization.
+        currentSpaces = zip(screens, observer.currentSpaceIDs()).map { screen, id in
+            space(withID: id, screen: screen).space
+        }
+        currentSpaces.forEach { $0.isVisible = true }
+        stateDelegate?.forEachWindowDelegate { place($0) }
+        DependencyTracker.shared.changed(.collection(.spaces))
+    }
+
+    /// The space `window` is on, or nil if it is on all spaces or hasn't been placed.
+    func space(of window: WindowDelegate) -> SpaceDelegate? {
+        guard case .space(let space)? = placements[ObjectIdentifier(window)] else { return nil }
+        return space
+    }
+
+    /// Whether `window` is on a visible space. Windows that haven't been placed are assumed to be.
+    func isOnVisibleSpace(_ window: WindowDelegate) -> Bool {
+        return space(of: window)?.isVisible ?? true
+    }
+
+    private var screens: [ScreenDelegate] {
+        return stateDelegate?.systemScreens.screens ?? []
+    }
+
+    private func space(withID id: Int,
+                       screen: ScreenDelegate) -> (space: SpaceDelegate, isNew: Bool) {
+        if let space = spacesByID[id] {
+            return (space, false)
+        }
+        let space = SpaceDelegate(id: id, screen: screen, stateDelegate: stateDelegate)
+        spacesByID[id] = space
+        knownSpaces.append(space)
+        return (space, true)
+    }
+
+    private func spacesChanged(_ ids: [Int]) {
+        assert(Thread.current.isMainThread)
+        guard isStarted else { return }
+        let screens = self.screens
+        var sawNewSpace = false
+        let newSpaces = zip(screens, ids).map { screen, id -> SpaceDelegate in
+            let (space, isNew) = self.space(withID: id, screen: screen)
+            sawNewSpace = sawNewSpace || isNew
+            return space
+        }
+        let oldSpaces = currentSpaces
+        guard newSpaces.map({ $0.id }) != oldSpaces.map({ $0.id }) else { return }
+
+        oldSpaces.forEach { $0.isVisible = false }
+        newSpaces.forEach { $0.isVisible = true }
+        currentSpaces = newSpaces
+        DependencyTracker.shared.changed(.collection(.spaces))
+
+        for (index, newSpace) in newSpaces.enumerated() {
+            let oldSpace = index < oldSpaces.count ? oldSpaces[index] : nil
+            guard oldSpace !== newSpace else { continue }
+            let lost = (oldSpace?.isVisible ?? true) ? [] : windows(of: oldSpace!)
+            notifier?.notify(SpaceChangedEvent(external: true,
+                                               screen: Screen(delegate: screens[index]),
+                                               oldValue: oldSpace.map { Space(delegate: $0) },
+                                               newValue: Space(delegate: newSpace),
+                                               windowsLost: lost,
+                                               windowsGained: windows(of: newSpace)))
+        }
+
+        if sawNewSpace {
+            scheduleDiscovery()
+        } else {
+            rediscoverUnplacedWindows()
+        }
+    }
+
+    private func windows(of space: SpaceDelegate) -> [Window] {
+        return space.windows.values.compactMap { Window(delegate: $0) }
+    }
+
+    private func place(_ window: WindowDelegate) {
+        guard isStarted, placements[ObjectIdentifier(window)] == nil else { return }
+        placeOnVisibleSpace(window)
+    }
+
+    /// Places `window` on the space visible on the screen most of it is on. Windows that are
+    /// entirely off-screen are placed on the first screen's space.
+    private func placeOnVisibleSpace(_ window: WindowDelegate) {
+        guard window.isValid, !currentSpaces.isEmpty else { return }
+        let index = indexOfScreen(containingMostOf: window.frame.getValue(), in: screens) ?? 0
+        guard index < currentSpaces.count else { return }
+        let space = currentSpaces[index]
+        let key = ObjectIdentifier(window)
+        placements[key] = .space(space)
+        space.windows[key] = window
+    }
+
+    private func windowMoved(_ window: WindowDelegate) {
+        guard isStarted else { return }
+        switch placements[ObjectIdentifier(window)] {
+        case .space(let space)? where space.isVisible:
+            let index = indexOfScreen(containingMostOf: window.frame.getValue(), in: screens)
+            guard let newIndex = index, newIndex < currentSpaces.count,
+                  currentSpaces[newIndex] !== space else { return }
+            forget(window)
+            placeOnVisibleSpace(window)
+            DependencyTracker.shared.changed(.collection(.spaces))
+        case nil, .unknown?:
+            placeOnVisibleSpace(window)
+        default:
+            // Windows on all spaces stay there, and windows on spaces out of view can't be moved
+            // by the user.
+            break
+        }
+    }
+
+    private func forget(_ window: WindowDelegate) {
+        let key = ObjectIdentifier(window)
+        guard let placement = placements.removeValue(forKey: key) else { return }
+        if case .space(let space) = placement {
+            space.windows.removeValue(forKey: key)
+        }
+    }
+}
+
+/// Discovery of windows on newly seen spaces.
+extension SpaceTracker {
+    private func scheduleDiscovery() {
+        stateDelegate?.forEachApplicationDelegate { application in
+            guard let pid = application.processIdentifier,
+                  !pendingDiscovery.contains(pid) else { return }
+            pendingDiscovery.append(pid)
+        }
+        if !isDiscoveryScheduled {
+            discoverNextBatch()
+        }
+    }
+
+    private func rediscoverUnplacedWindows() {
+        var pids: [pid_t] = []
+        for case .unknown(let pid) in placements.values where !pids.contains(pid) {
+            pids.append(pid)
+        }
+        guard !pids.isEmpty else { return }
+        for pid in pids where !pendingDiscovery.contains(pid) {
+            pendingDiscovery.append(pid)
+        }
+        if !isDiscoveryScheduled {
+            discoverNextBatch()
+        }
+    }
+
+    private func scheduleNextBatch() {
+        guard !isDiscoveryScheduled, !pendingDiscovery.isEmpty else { return }
+        isDiscoveryScheduled = true
+        DispatchQueue.main.asyncAfter(deadline: .now() + discoveryInterval) { [weak self] in
+            guard let self = self else { return }
+            self.isDiscoveryScheduled = false
+            self.discoverNextBatch()
+        }
+    }
+
+    private func discoverNextBatch() {
+        guard let stateDelegate = stateDelegate else { return }
+        var applications: [pid_t: ApplicationDelegate] = [:]
+        stateDelegate.forEachApplicationDelegate { applications[$0.processIdentifier] = $0 }
+
+        let budget = stateDelegate.polling.ipcBudget
+        var batch: [ApplicationDelegate] = []
+        while batch.count < discoveryBatchSize, let pid = pendingDiscovery.first {
+            guard let application = applications[pid] else {
+                // It terminated.
+                pendingDiscovery.removeFirst()
+                continue
+            }
+            // One request for the window list; new windows are paid for when they're found.
+            guard budget.tryConsume(1) else { break }
+            pendingDiscovery.removeFirst()
+            batch.append(application)
+        }
+
+        // The window lists only mean something for the spaces that are visible while they're read.
+        let spaceIDs = currentSpaces.map { $0.id }
+        for application in batch {
+            let pid = application.processIdentifier!
+            application.discoverWindows().done { [weak self] result in
+                self?.didDiscover(result.discovered,
+                                  listed: result.listed,
+                                  budget: budget,
+                                  pid: pid,
+                                  spaceIDs: spaceIDs)
+            }.catch { error in
+                log.debug("Couldn't discover windows of \(application): \(error)")
+            }
+        }
+        scheduleNextBatch()
+    }
+
+    /// Places the windows found by discovering the windows of `pid`. `spaceIDs` are the spaces
+    /// that were visible when the window list was requested.
+    private func didDiscover(_ discovered: [WindowDelegate],
+                             listed: [WindowDelegate],
+                             budget: IPCBudget,
+                             pid: pid_t,
+                             spaceIDs: [Int]) {
+        budget.forceConsume(discovered.count)
+
+        // If the spaces changed while the list was being read, the list may be from either set of
+        // spaces, so nothing can be placed from it. The new windows are placed when the
+        // application is discovered again, which is right away and after every space switch
+        // until it works.
+        if currentSpaces.map({ $0.id }) != spaceIDs {
+            for window in discovered {
+                placements[ObjectIdentifier(window)] = .unknown(pid)
+            }
+            if !pendingDiscovery.contains(pid) {
+                pendingDiscovery.append(pid)
+            }
+            scheduleNextBatch()
+        } else {
+            var changed = false
+            for window in listed {
+                switch placements[ObjectIdentifier(window)] {
+                case .space(let space)? where !space.isVisible:
+                    forget(window)
+                    placements[ObjectIdentifier(window)] = .allSpaces
+                    // No event covers this, and the window went out of view with its old space.
+                    stateDelegate?.visibleWindows.update(window)
+                    changed = true
+                case nil, .unknown?:
+                    // Left unplaced by an earlier discovery.
+                    placeOnVisibleSpace(window)
+                    changed = true
+                default:
+                    break
+                }
+            }
+            for window in discovered {
+                placeOnVisibleSpace(window)
+            }
+            if changed || !discovered.isEmpty {
+                DependencyTracker.shared.changed(.collection(.spaces))
+            }
+        }
+
+        discoveredWindowCount += discovered.count
+        for window in discovered.compactMap({ Window(delegate: $0) }) {
+            notifier?.notify(WindowDiscoveredEvent(external: true, window: window))
+        }
+    }
+}
+
+// MARK: - Public API
+
+extension State {
+    /// All spaces the user has been to since Swindler was started, in the order they were first
+    /// seen. Empty unless `Configuration.spaceTracking` is on.
+    public var knownSpaces: [Space] {
+        DependencyTracker.shared.recordRead(.collection(.spaces))
+        return delegate.spaces.knownSpaces.map { Space(delegate: $0) }
+    }
+
+    /// The space visible on each screen, in the order of `screens`. Empty unless
+    /// `Configuration.spaceTracking` is on.
+    public var currentSpaces: [Space] {
+        DependencyTracker.shared.recordRead(.collection(.spaces))
+        return delegate.spaces.currentSpaces.map { Space(delegate: $0) }
+    }
+
+    /// The space visible on `screen`.
+    public func currentSpace(on screen: Screen) -> Space? {
+        DependencyTracker.shared.recordRead(.collection(.spaces))
+        let currentSpaces = delegate.spaces.currentSpaces
+        guard let index = delegate.systemScreens.screens.firstIndex(where: {
+            $0 === screen.delegate || $0.equalTo(screen.delegate)
+        }), index < currentSpaces.count else {
+            return nil
+        }
+        return Space(delegate: currentSpaces[index])
+    }
+}
+
+extension Window {
+    /// The space the window is on. `nil` if it is on all spaces, or Swindler hasn't placed it yet.
+    public var space: Space? {
+        DependencyTracker.shared.recordRead(.collection(.spaces))
+        return application.swindlerState.delegate.spaces.space(of: delegate).map {
+            Space(delegate: $0)
+        }
+    }
+}
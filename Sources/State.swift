@@ -2,18 +2,130 @@ import AXSwift
 import Cocoa
 import PromiseKit
 
-/// Initializes a new Swindler state and returns it in a Promise.
-public func initialize() -> Promise<State> {
-    return OSXStateDelegate<
-        AXSwift.UIElement,
-        AXSwift.Application,
-        AXSwift.Observer,
-        ApplicationObserver
-    >.initialize(
-        appObserver: ApplicationObserver(),
-        screens: OSXSystemScreenDelegate()
-    ).map { delegate in
-       State(delegate: delegate)
+/// Options for `initialize(configuration:consumer:)`.
+public struct Configuration: Equatable {
+    /// The number of threads to receive accessibility notifications on. Applications are spread
+    /// across them, and each application's notifications are handed to the main thread in batches,
+    /// in the order they arrived. This keeps the main thread's run loop free of accessibility
+    /// callbacks when many applications are busy.
+    ///
+    /// When 0, the default, notifications are received on the main thread.
+    public var observerThreads = 0
+
+    /// Whether window properties other than `frame` and `isMinimized` are read only when first
+    /// needed: when they are first read, refreshed or written, or, for `title`, once a
+    /// `WindowTitleChangedEvent` handler is added. This makes startup cheaper when there are many
+    /// windows. The first read of a property that hasn't been fetched blocks on a request to the
+    /// application. If the request fails, the property reads as a placeholder, such as an empty
+    /// title, and the request is retried in the background, with backoff, as it is read again.
+    ///
+    /// A lazy property's `initialized` promise resolves once its value has been fetched, rather
+    /// than when the window is created.
+    public var lazyWindowProperties = false
+
+    /// Whether spaces are tracked (see `State.knownSpaces`). Swindler identifies a space by leaving
+    /// an invisible, borderless window of your process on it the first time it is seen, so this is
+    /// off by default. The windows are closed once the last state returned by `initialize` is
+    /// released.
+    ///
+    /// When off, there are no known spaces, `Window.space` is always `nil`, no `SpaceChangedEvent`
+    /// or `WindowDiscoveredEvent` is emitted, and every window counts as visible.
+    public var spaceTracking = false
+
+    public init() {}
+}
+
+/// Initializes Swindler and returns the state in a Promise. Must be called on the main thread.
+///
+/// All callers in a process share one model, so calling this from several independent modules
+/// costs no additional accessibility observers or requests. The model is created by the first
+/// call, with its configuration, and is kept for as long as a state returned by this function is
+/// alive.
+///
+/// Each caller's event handlers are its own: handlers added through the returned state are
+/// removed when it is released, and the CPU time they use is attributed to `consumer` (see
+/// `Metrics.handlerCPUTimeByConsumer`). Only handler time is attributed; the accessibility
+/// requests and other work of the shared model aren't, since every caller benefits from them.
+public func initialize(configuration: Configuration = Configuration(),
+                       consumer: String? = nil) -> Promise<State> {
+    assert(Thread.current.isMainThread)
+    let model: SharedModel
+    if let current = SharedModel.current {
+        if current.configuration != configuration {
+            log.warn("Swindler is already initialized with a different configuration, which "
+                   + "will be used for \(consumer ?? "this caller") as well")
+        }
+        model = current
+    } else {
+        model = SharedModel(configuration: configuration)
+        SharedModel.current = model
+    }
+    model.addConsumer()
+    return model.delegate.map { delegate in
+        State(delegate: delegate, consumer: Consumer(of: model, delegate: delegate, name: consumer))
+    }.recover { error -> Promise<State> in
+        model.removeConsumer()
+        throw error
+    }
+}
+
+// MARK: - Sharing
+
+/// The model shared by the callers of `initialize`. Reference counted by the consumers; once the
+/// last one is gone, the next caller gets a new model.
+///
+/// Only used on the main thread.
+private final class SharedModel {
+    static var current: SharedModel?
+
+    let configuration: Configuration
+    let delegate: Promise<StateDelegate>
+    private var consumerCount = 0
+
+    init(configuration: Configuration) {
+        self.configuration = configuration
+        delegate = OSXStateDelegate<
+            AXSwift.UIElement,
+            AXSwift.Application,
+            AXSwift.Observer,
+            ApplicationObserver
+        >.initialize(
+            appObserver: ApplicationObserver(),
+            screens: OSXSystemScreenDelegate(),
+            spaces: OSXSpaceObserver(),
+            configuration: configuration
+        ).map { $0 as StateDelegate }
+    }
+
+    func addConsumer() {
+        consumerCount += 1
+    }
+
+    func removeConsumer() {
+        consumerCount -= 1
+        if consumerCount == 0 && SharedModel.current === self {
+            SharedModel.current = nil
+        }
+    }
+}
+
+/// One caller of `initialize`, with its own event subscriptions. Keeps the shared model alive.
+final class Consumer {
+    let notifier: EventNotifier
+    private let release: () -> Void
+
+    fileprivate init(of model: SharedModel, delegate: StateDelegate, name: String?) {
+        notifier = EventNotifier(consumerOf: delegate.notifier, name: name)
+        release = { [model] in model.removeConsumer() }
+    }
+
+    deinit {
+        let release = self.release
+        if Thread.current.isMainThread {
+            release()
+        } else {
+            DispatchQueue.main.async(execute: release)
+        }
     }
 }
 
@@ -23,15 +135,31 @@ public func initialize() -> Promise<State> {
 /// spaces.
 public final class State {
     let delegate: StateDelegate
-    init(delegate: StateDelegate) {
+
+    // Set on the states returned by `initialize`. Other states, such as
+    // `Application.swindlerState`, subscribe directly to the model's events.
+    private let consumer: Consumer?
+    private var notifier: EventNotifier { return consumer?.notifier ?? delegate.notifier }
+
+    init(delegate: StateDelegate, consumer: Consumer? = nil) {
         self.delegate = delegate
+        self.consumer = consumer
     }
 
     /// The currently running applications.
     public var runningApplications: [Application] {
+        DependencyTracker.shared.recordRead(.collection(.applications))
         return delegate.runningApplications.map {Application(delegate: $0, stateDelegate: delegate)}
     }
 
+    /// The running applications with the given bundle identifier.
+    public func applications(bundleID: String) -> [Application] {
+        DependencyTracker.shared.recordRead(.collection(.applications))
+        return delegate.applications(bundleID: bundleID).map {
+            Application(delegate: $0, stateDelegate: delegate)
+        }
+    }
+
     /// The frontmost application.
     public var frontmostApplication: WriteableProperty<OfOptionalType<Application>> {
         return delegate.frontmostApplication
@@ -39,17 +167,42 @@ public final class State {
 
     /// All windows that we know about. Windows on spaces that we haven't seen yet aren't included.
     public var knownWindows: [Window] {
+        DependencyTracker.shared.recordRead(.collection(.windows))
         return delegate.knownWindows.compactMap {Window(delegate: $0)}
     }
 
     /// The physical screens in the current display configuration.
     public var screens: [Screen] {
+        DependencyTracker.shared.recordRead(.collection(.screens))
         return delegate.systemScreens.screens.map {Screen(delegate: $0)}
     }
 
     /// Calls `handler` when the specified `Event` occurs.
     public func on<Event: EventType>(_ handler: @escaping (Event) -> Void) {
-        delegate.notifier.on(handler)
+        notifier.on(handler)
+    }
+
+    /// Calls `handler` when the specified `Event` occurs.
+    ///
+    /// When `Metrics.isHandlerProfilingEnabled` is set, the CPU time the handler uses is reported
+    /// under `label` by `Metrics.slowestHandlers`.
+    ///
+    /// - parameter budget: The CPU time a single call may take, in seconds, before a warning is
+    ///                     logged. Defaults to `Metrics.handlerBudget`.
+    public func on<Event: EventType>(label: String,
+                                     budget: TimeInterval? = nil,
+                                     _ handler: @escaping (Event) -> Void) {
+        notifier.on(label: label, budget: budget, handler)
+    }
+
+    /// Calls `handler` when the frame of a window settles.
+    ///
+    /// Changes made by Swindler are delivered immediately. External changes are delivered once the
+    /// window has stopped changing, so an interactive move or resize results in a single event
+    /// going from the frame before the gesture to the final frame. Use `WindowDragBeganEvent` and
+    /// `WindowDragEndedEvent` to find out when such a gesture is in progress.
+    public func onSettledFrameChange(_ handler: @escaping (WindowFrameChangedEvent) -> Void) {
+        notifier.onSettledFrameChange(handler)
     }
 }
 
@@ -60,11 +213,20 @@ public final class State {
 // the functioning of the class, so they are not held with weak references.
 protocol StateDelegate: AnyObject {
     var runningApplications: [ApplicationDelegate] { get }
+    func applications(bundleID: String) -> [ApplicationDelegate]
     var frontmostApplication: WriteableProperty<OfOptionalType<Application>>! { get }
     var knownWindows: [WindowDelegate] { get }
     var systemScreens: SystemScreenDelegate { get }
 
+    // Non-allocating alternatives to runningApplications and knownWindows.
+    func forEachApplicationDelegate(_ body: (ApplicationDelegate) throws -> Void) rethrows
+    func forEachWindowDelegate(_ body: (WindowDelegate) throws -> Void) rethrows
+
     var notifier: EventNotifier { get }
+    var polling: PollingSupervisor { get }
+    var visibleWindows: VisibleWindowIndex { get }
+    var spaces: SpaceTracker { get }
+    var configuration: Configuration { get }
 }
 
 // MARK: - OSXStateDelegate
@@ -76,6 +238,7 @@ protocol ApplicationObserverType {
     func onApplicationLaunched(_ handler: @escaping (pid_t) -> Void)
     func onApplicationTerminated(_ handler: @escaping (pid_t) -> Void)
     func makeApplicationFrontmost(_ pid: pid_t) throws
+    func metadata(forProcessID processID: pid_t) -> ApplicationMetadata
 
     associatedtype ApplicationElement: ApplicationElementType
     func allApplications() -> [ApplicationElement]
@@ -85,24 +248,99 @@ protocol ApplicationObserverType {
 /// Simple pubsub.
 class EventNotifier {
     private typealias EventHandler = (EventType) -> Void
-    private var eventHandlers: [String: [EventHandler]] = [:]
+    private struct Subscription {
+        let handler: EventHandler
+        let stats: HandlerStats
+    }
+    private var eventHandlers: [String: [Subscription]] = [:]
+    private var subscriptionHandlers: [String: [() -> Void]] = [:]
+
+    // The notifiers of the consumers sharing this one's events. See `init(consumerOf:name:)`.
+    private let consumers = NSHashTable<EventNotifier>.weakObjects()
+    private weak var source: EventNotifier?
+    let consumerName: String?
+
+    /// Turns streams of frame changes into drag events. Registered first, so that a
+    /// WindowDragBeganEvent is delivered before the frame change that triggered it.
+    ///
+    /// Consumer notifiers receive drag events from their source, and don't have one.
+    private(set) var dragDetector: DragDetector!
+
+    init() {
+        consumerName = nil
+        dragDetector = DragDetector(notifier: self)
+    }
+
+    /// Creates a notifier for one consumer of a shared model. It delivers every event `source`
+    /// delivers, after `source`'s own handlers, for as long as it is alive. The metrics of its
+    /// handlers are attributed to `name`.
+    init(consumerOf source: EventNotifier, name: String?) {
+        consumerName = name
+        self.source = source
+        source.consumers.add(self)
+    }
+
+    func hasHandlers<Event: EventType>(for event: Event.Type) -> Bool {
+        return !(eventHandlers[Event.typeName]?.isEmpty ?? true)
+            || consumers.allObjects.contains { $0.hasHandlers(for: event) }
+    }
+
+    /// Calls `handler` whenever a handler for `Event` is added.
+    func onSubscribe<Event: EventType>(to event: Event.Type, _ handler: @escaping () -> Void) {
+        subscriptionHandlers[Event.typeName, default: []].append(handler)
+    }
 
-    func on<Event: EventType>(_ handler: @escaping (Event) -> Void) {
+    func on<Event: EventType>(label: String? = nil,
+                              budget: TimeInterval? = nil,
+                              _ handler: @escaping (Event) -> Void) {
         let notification = Event.typeName
         if eventHandlers[notification] == nil {
             eventHandlers[notification] = []
         }
+        let stats = HandlerStats(label: label,
+                                 eventType: notification,
+                                 budget: budget,
+                                 consumer: consumerName)
+        Metrics.shared.register(stats)
         // Wrap in a casting closure to preserve type information that gets erased in the
         // dictionary.
-        eventHandlers[notification]!.append({ handler($0 as! Event) })
+        eventHandlers[notification]!.append(
+            Subscription(handler: { handler($0 as! Event) }, stats: stats)
+        )
+        subscribed(to: notification)
+    }
+
+    private func subscribed(to notification: String) {
+        subscriptionHandlers[notification]?.forEach { $0() }
+        source?.subscribed(to: notification)
     }
 
     func notify<Event: EventType>(_ event: Event) {
         assert(Thread.current.isMainThread)
-        if let handlers = eventHandlers[Event.typeName] {
-            for handler in handlers {
-                handler(event)
+        deliver(event)
+        for consumer in consumers.allObjects {
+            consumer.notify(event)
+        }
+    }
+
+    private func deliver<Event: EventType>(_ event: Event) {
+        let notification = Event.typeName
+        guard let subscriptions = eventHandlers[notification] else { return }
+
+        let metrics = Metrics.shared
+        let profile = metrics.isHandlerProfilingEnabled
+        for (index, subscription) in subscriptions.enumerated() {
+            let token = metrics.activity.beginHandler(event: notification,
+                                                      index: index,
+                                                      label: subscription.stats.label)
+            if profile {
+                let start = metrics.beginProfiling()
+                subscription.handler(event)
+                subscription.stats.record(metrics.endProfiling(start: start))
+            } else {
+                subscription.handler(event)
             }
+            metrics.activity.endHandler(token)
         }
     }
 }
@@ -180,6 +418,13 @@ struct ApplicationObserver: ApplicationObserverType {
         }
     }
 
+    func metadata(forProcessID processID: pid_t) -> ApplicationMetadata {
+        guard let app = NSRunningApplication(processIdentifier: processID) else {
+            return ApplicationMetadata()
+        }
+        return ApplicationMetadata(app)
+    }
+
     typealias ApplicationElement = AXSwift.Application
 
     func allApplications() -> [ApplicationElement] {
@@ -206,9 +451,22 @@ final class OSXStateDelegate<
     typealias AppDelegate = OSXApplicationDelegate<UIElement, ApplicationElement, Observer>
 
     private var applicationsByPID: [pid_t: AppDelegate] = [:]
+    private var applicationsByBundleID: [String: [AppDelegate]] = [:]
     var notifier: EventNotifier
+    private(set) lazy var polling = PollingSupervisor(targets: { [weak self] in
+        self?.applications.map { $0 as PollTarget } ?? []
+    })
 
     fileprivate var appObserver: ApplicationObserver
+    private var focusTracker: FocusTracker!
+    private(set) lazy var visibleWindows = VisibleWindowIndex(notifier: notifier,
+                                                              stateDelegate: self)
+    private let spaceObserver: SpaceObserver
+    let configuration: Configuration
+    private let observerThreads: ObserverThreadPool?
+    private(set) lazy var spaces = SpaceTracker(notifier: notifier,
+                                                observer: spaceObserver,
+                                                stateDelegate: self)
 
     // For convenience/readability.
     fileprivate var applications: Dictionary<pid_t, AppDelegate>.Values {
@@ -218,10 +476,23 @@ final class OSXStateDelegate<
     var runningApplications: [ApplicationDelegate] {
         return applications.map({ $0 as ApplicationDelegate })
     }
+    func applications(bundleID: String) -> [ApplicationDelegate] {
+        return (applicationsByBundleID[bundleID] ?? []).map({ $0 as ApplicationDelegate })
+    }
     var frontmostApplication: WriteableProperty<OfOptionalType<Application>>!
     var knownWindows: [WindowDelegate] {
         return applications.flatMap({ $0.knownWindows })
     }
+    func forEachApplicationDelegate(_ body: (ApplicationDelegate) throws -> Void) rethrows {
+        for app in applications {
+            try body(app)
+        }
+    }
+    func forEachWindowDelegate(_ body: (WindowDelegate) throws -> Void) rethrows {
+        for app in applications {
+            try app.forEachWindowDelegate(body)
+        }
+    }
     var systemScreens: SystemScreenDelegate
 
     fileprivate var initialized: Promise<Void>!
@@ -231,23 +502,46 @@ final class OSXStateDelegate<
 
     static func initialize<S: SystemScreenDelegate>(
         appObserver: ApplicationObserver,
-        screens: S
+        screens: S,
+        spaces: SpaceObserver,
+        configuration: Configuration = Configuration()
     ) -> Promise<OSXStateDelegate> {
         return firstly { () -> Promise<OSXStateDelegate> in
-            let delegate = OSXStateDelegate(appObserver: appObserver, screens: screens)
-            return delegate.initialized.map { delegate }
+            let delegate = OSXStateDelegate(appObserver: appObserver,
+                                            screens: screens,
+                                            spaces: spaces,
+                                            configuration: configuration)
+            return delegate.initialized.map {
+                delegate.focusTracker.start()
+                // The space tracker must start first, so that windows are placed on spaces before
+                // the visible windows are indexed.
+                if configuration.spaceTracking {
+                    delegate.spaces.start()
+                }
+                delegate.visibleWindows.rebuild()
+                return delegate
+            }
         }
     }
 
     // TODO make private
-    init<S: SystemScreenDelegate>(appObserver: ApplicationObserver, screens ssd: S) {
+    init<S: SystemScreenDelegate>(appObserver: ApplicationObserver,
+                                  screens ssd: S,
+                                  spaces: SpaceObserver,
+                                  configuration: Configuration = Configuration()) {
         log.debug("Initializing Swindler")
 
         notifier = EventNotifier()
         systemScreens = ssd
         self.appObserver = appObserver
+        spaceObserver = spaces
+        self.configuration = configuration
+        observerThreads = configuration.observerThreads > 0
+            ? ObserverThreadPool(count: configuration.observerThreads)
+            : nil
 
         ssd.onScreenLayoutChanged { event in
+            DependencyTracker.shared.changed(.collection(.screens))
             self.notifier.notify(event)
         }
 
@@ -277,6 +571,25 @@ final class OSXStateDelegate<
         appObserver.onApplicationLaunched(onApplicationLaunch)
         appObserver.onApplicationTerminated(onApplicationTerminate)
 
+        if configuration.lazyWindowProperties {
+            // Title events need the old title, so from now on titles are needed.
+            notifier.onSubscribe(to: WindowTitleChangedEvent.self) { [weak self] in
+                self?.forEachWindowDelegate { ($0 as? WinDelegate)?.requestLazyProperties() }
+            }
+        }
+
+        // Bring an application's windows up to date as it becomes frontmost.
+        notifier.on(label: "Prefetch") { [weak self] (event: FrontmostApplicationChangedEvent) in
+            guard let self = self,
+                  let target = event.newValue?.delegate as? PollTarget else { return }
+            self.polling.prefetch(target)
+        }
+
+        focusTracker = FocusTracker(notifier: notifier) { [weak self] in
+            let application = self?.frontmostApplication.value
+            return (application, application?.focusedWindow.value)
+        }
+
         // Must not allow frontmostApplication to initialize until the observer is in place.
         when(fulfilled: appPromises)
             //.asVoid()
@@ -290,35 +603,81 @@ final class OSXStateDelegate<
         }
 
         initialized = initializeProperties(properties).asVoid()
+
+        MemoryBudget.shared.register(self, priority: .last)
+
+        // The first audit runs one audit interval from now.
+        polling.schedule()
     }
 
     func watchApplication(appElement: ApplicationElement) -> Promise<AppDelegate> {
-        return watchApplication(appElement: appElement, retry: 0)
+        // Look up the metadata once, up front; it's reused across retries and for logging.
+        let pid = try? appElement.pid()
+        let metadata = pid.map { appObserver.metadata(forProcessID: $0) } ?? ApplicationMetadata()
+        return watchApplication(appElement: appElement, metadata: metadata, retry: 0)
+            .recover { error -> Promise<AppDelegate> in
+                // Log errors
+                let pidString = (pid == nil) ? "??" : String(pid!)
+                log.notice("Could not watch application \(metadata.bundleIdentifier ?? "") "
+                         + "(pid=\(pidString)): " + String(describing: error))
+                throw error
+            }
     }
 
-    func watchApplication(appElement: ApplicationElement, retry: Int) -> Promise<AppDelegate> {
-        return AppDelegate.initialize(axElement: appElement, stateDelegate: self, notifier: notifier)
+    private func watchApplication(appElement: ApplicationElement,
+                                  metadata: ApplicationMetadata,
+                                  retry: Int) -> Promise<AppDelegate> {
+        return AppDelegate.initialize(axElement: appElement,
+                                      stateDelegate: self,
+                                      notifier: notifier,
+                                      metadata: metadata,
+                                      observerThread: observerThread(for: appElement))
             .map { appDelegate in
-                self.applicationsByPID[try appDelegate.axElement.pid()] = appDelegate
+                self.addApplication(appDelegate)
                 return appDelegate
             }
-            //.asVoid()
             .recover { error -> Promise<AppDelegate> in
                 if retry < 3 {
-                    return self.watchApplication(appElement: appElement, retry: retry + 1)
+                    return self.watchApplication(appElement: appElement,
+                                                 metadata: metadata,
+                                                 retry: retry + 1)
                 }
                 throw error
             }
-            .recover { error -> Promise<AppDelegate> in
-                // Log errors
-                let pid = try? appElement.pid()
-                let bundleID = pid.flatMap { NSRunningApplication(processIdentifier: $0) }
-                    .flatMap { $0.bundleIdentifier }
-                let pidString = (pid == nil) ? "??" : String(pid!)
-                log.notice("Could not watch application \(bundleID ?? "") (pid=\(pidString)): "
-                         + String(describing: error))
-                throw error
+    }
+
+    private func observerThread(for appElement: ApplicationElement) -> ObserverThread? {
+        guard let pool = observerThreads, let pid = try? appElement.pid() else { return nil }
+        return pool.thread(for: pid)
+    }
+
+    private func addApplication(_ appDelegate: AppDelegate) {
+        let pid: pid_t = appDelegate.processIdentifier
+        if applicationsByPID[pid] != nil {
+            removeApplication(pid)
+        }
+        applicationsByPID[pid] = appDelegate
+        if let bundleID = appDelegate.metadata.bundleIdentifier {
+            applicationsByBundleID[bundleID, default: []].append(appDelegate)
+        }
+        DependencyTracker.shared.changed(.collection(.applications))
+        DependencyTracker.shared.changed(.collection(.windows))
+    }
+
+    @discardableResult
+    fileprivate func removeApplication(_ pid: pid_t) -> AppDelegate? {
+        guard let appDelegate = applicationsByPID.removeValue(forKey: pid) else {
+            return nil
+        }
+        if let bundleID = appDelegate.metadata.bundleIdentifier {
+            applicationsByBundleID[bundleID]?.removeAll(where: { $0 === appDelegate })
+            if applicationsByBundleID[bundleID]?.isEmpty ?? false {
+                applicationsByBundleID.removeValue(forKey: bundleID)
             }
+        }
+        DependencyTracker.shared.changed(.collection(.applications))
+        DependencyTracker.shared.changed(.collection(.windows))
+        return appDelegate
     }
 }
 
@@ -345,19 +704,37 @@ extension OSXStateDelegate {
     }
 
     fileprivate func onApplicationTerminate(_ pid: pid_t) {
-        guard let appDelegate = self.applicationsByPID[pid] else {
+        guard let appDelegate = removeApplication(pid) else {
             log.debug("Saw termination for unknown pid \(pid)")
             return
         }
-        applicationsByPID.removeValue(forKey: pid)
         notifier.notify(ApplicationTerminatedEvent(
             external: true,
             application: Application(delegate: appDelegate, stateDelegate: self)
         ))
+        appDelegate.releaseResources()
+        polling.remove(pid)
         // TODO: Clean up observers?
     }
 }
 
+// Actions deferred until a window finishes initializing pile up if the window never does.
+extension OSXStateDelegate: EvictableCache {
+    var cacheName: String { return "deferred window handlers" }
+
+    var estimatedCost: Int {
+        return applications.reduce(0) { $0 + $1.deferredWindowHandlerCost }
+    }
+
+    func evict(bytes: Int) -> Int {
+        var freed = 0
+        for app in applications where freed < bytes {
+            freed += app.evictDeferredWindowHandlers(bytes: bytes - freed)
+        }
+        return freed
+    }
+}
+
 extension OSXStateDelegate: PropertyNotifier {
     typealias Object = State
 
@@ -428,16 +805,7 @@ private final class FrontmostApplicationPropertyDelegate<
     }
 
     fileprivate func findAppByPID(_ pid: pid_t) -> Application? {
-        // TODO: extract into runOnMainThread util
         // Avoid using locks by forcing calls out to `windowFinder` to happen on the main thead.
-        var app: Application?
-        if Thread.current.isMainThread {
-            app = appFinder?.findAppByPID(pid)
-        } else {
-            DispatchQueue.main.sync {
-                app = self.appFinder?.findAppByPID(pid)
-            }
-        }
-        return app
+        return syncOnMainThread("findAppByPID") { self.appFinder?.findAppByPID(pid) }
     }
 }
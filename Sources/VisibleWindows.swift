@@ -0,0 +1,213 @@
+import Cocoa
+
+// MARK: - VisibleWindowIndex
+
+/// Keeps track of which windows are visible, by application and by screen, so that they can be
+/// listed without checking every known window.
+///
+/// A window is visible if it is not minimized, its application is not hidden, it is on a visible
+/// space, and it is at least partly on a screen. Its screen is the one most of it is on, as with
+/// `Window.screen`.
+///
+/// The index is updated from events: window creation, discovery and destruction, minimizing, frame
+/// changes, applications being hidden, launched or terminated, space changes, and screen layout
+/// changes. Windows that become invalid are dropped when they are next listed.
+///
+/// Lives on the main thread, like `EventNotifier`.
+final class VisibleWindowIndex {
+    private final class Entry {
+        let delegate: WindowDelegate
+        let pid: pid_t
+        var screen: ObjectIdentifier?
+
+        init(delegate: WindowDelegate, pid: pid_t) {
+            self.delegate = delegate
+            self.pid = pid
+        }
+    }
+
+    private var entries: [ObjectIdentifier: Entry] = [:]
+    private var byProcess: [pid_t: [ObjectIdentifier: WindowDelegate]] = [:]
+    private var byScreen: [ObjectIdentifier: [ObjectIdentifier: WindowDelegate]] = [:]
+
+    private weak var stateDelegate: StateDelegate?
+
+    init(notifier: EventNotifier, stateDelegate: StateDelegate) {
+        self.stateDelegate = stateDelegate
+
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (event: WindowCreatedEvent) in
+            self?.update(event.window.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (event: WindowDiscoveredEvent) in
+            self?.update(event.window.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (event: WindowDestroyedEvent) in
+            self?.remove(event.window.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") {
+            [weak self] (event: WindowMinimizedChangedEvent) in
+            self?.update(event.window.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (event: WindowFrameChangedEvent) in
+            self?.update(event.window.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") {
+            [weak self] (event: ApplicationIsHiddenChangedEvent) in
+            self?.updateWindows(of: event.application.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (event: ApplicationLaunchedEvent) in
+            self?.updateWindows(of: event.application.delegate)
+        }
+        notifier.on(label: "VisibleWindowIndex") {
+            [weak self] (event: ApplicationTerminatedEvent) in
+            self?.removeWindows(ofProcess: event.application.processIdentifier)
+        }
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (event: SpaceChangedEvent) in
+            // Only the windows of the spaces that switched can have changed.
+            for window in event.windowsLost + event.windowsGained {
+                self?.update(window.delegate)
+            }
+        }
+        notifier.on(label: "VisibleWindowIndex") { [weak self] (_: ScreenLayoutChangedEvent) in
+            self?.rebuild()
+        }
+    }
+
+    /// Re-evaluates every known window. Called once the state is initialized, and when the screen
+    /// layout changes.
+    func rebuild() {
+        assert(Thread.current.isMainThread)
+        let hadWindows = !entries.isEmpty
+        entries = [:]
+        byProcess = [:]
+        byScreen = [:]
+        stateDelegate?.forEachWindowDelegate { insertIfVisible($0) }
+        if hadWindows || !entries.isEmpty {
+            DependencyTracker.shared.changed(.collection(.visibleWindows))
+        }
+    }
+
+    /// All visible windows.
+    var windows: [WindowDelegate] {
+        return entries.values.compactMap { $0.delegate.isValid ? $0.delegate : nil }
+    }
+
+    /// Whether `window` is visible.
+    func contains(_ window: WindowDelegate) -> Bool {
+        return entries[ObjectIdentifier(window)] != nil && window.isValid
+    }
+
+    /// The visible windows of the application with process identifier `pid`.
+    func windows(ofProcess pid: pid_t) -> [WindowDelegate] {
+        return (byProcess[pid] ?? [:]).values.filter { $0.isValid }
+    }
+
+    /// The visible windows that are mostly on `screen`.
+    func windows(on screen: ScreenDelegate) -> [WindowDelegate] {
+        // Screens are matched by identity; a screen layout change replaces them all, and rebuilds
+        // the index.
+        let screens = stateDelegate?.systemScreens.screens ?? []
+        let key = screens.first { $0.equalTo(screen) }.map { ObjectIdentifier($0) }
+            ?? ObjectIdentifier(screen)
+        return (byScreen[key] ?? [:]).values.filter { $0.isValid }
+    }
+
+    /// Re-evaluates `window`. Events cover most changes; this is for the rest.
+    func update(_ window: WindowDelegate) {
+        assert(Thread.current.isMainThread)
+        let key = ObjectIdentifier(window)
+        let wasVisible = entries[key] != nil
+        let oldScreen = entries[key]?.screen
+        removeEntry(key)
+        insertIfVisible(window)
+        if wasVisible != (entries[key] != nil) || oldScreen != entries[key]?.screen {
+            DependencyTracker.shared.changed(.collection(.visibleWindows))
+        }
+    }
+
+    private func updateWindows(of application: ApplicationDelegate) {
+        application.forEachWindowDelegate { update($0) }
+    }
+
+    private func remove(_ window: WindowDelegate) {
+        if removeEntry(ObjectIdentifier(window)) {
+            DependencyTracker.shared.changed(.collection(.visibleWindows))
+        }
+    }
+
+    private func removeWindows(ofProcess pid: pid_t) {
+        guard let windows = byProcess[pid] else { return }
+        for key in windows.keys {
+            removeEntry(key)
+        }
+        DependencyTracker.shared.changed(.collection(.visibleWindows))
+    }
+
+    private func insertIfVisible(_ window: WindowDelegate) {
+        guard window.isValid,
+              let application = window.appDelegate,
+              !window.isMinimized.getValue(),
+              !application.isHidden.getValue(),
+              stateDelegate?.spaces.isOnVisibleSpace(window) ?? true,
+              let screen = screen(containingMostOf: window.frame.getValue()) else {
+            return
+        }
+        let key = ObjectIdentifier(window)
+        let entry = Entry(delegate: window, pid: application.processIdentifier)
+        entry.screen = ObjectIdentifier(screen)
+        entries[key] = entry
+        byProcess[entry.pid, default: [:]][key] = window
+        byScreen[ObjectIdentifier(screen), default: [:]][key] = window
+    }
+
+    @discardableResult
+    private func removeEntry(_ key: ObjectIdentifier) -> Bool {
+        guard let entry = entries.removeValue(forKey: key) else { return false }
+        byProcess[entry.pid]?.removeValue(forKey: key)
+        if byProcess[entry.pid]?.isEmpty == true {
+            byProcess.removeValue(forKey: entry.pid)
+        }
+        if let screen = entry.screen {
+            byScreen[screen]?.removeValue(forKey: key)
+            if byScreen[screen]?.isEmpty == true {
+                byScreen.removeValue(forKey: screen)
+            }
+        }
+        return true
+    }
+
+    private func screen(containingMostOf frame: CGRect) -> ScreenDelegate? {
+        let screens = stateDelegate?.systemScreens.screens ?? []
+        return indexOfScreen(containingMostOf: frame, in: screens).map { screens[$0] }
+    }
+}
+
+extension State {
+    /// All windows that are currently visible on a screen, including those fully covered by other
+    /// windows. This does not include windows that are minimized or whose application is hidden.
+    ///
+    /// This is kept up to date incrementally, so listing it only costs as much as the number of
+    /// visible windows.
+    public var visibleWindows: [Window] {
+        DependencyTracker.shared.recordRead(.collection(.visibleWindows))
+        return delegate.visibleWindows.windows.compactMap { Window(delegate: $0) }
+    }
+
+    /// The visible windows that are mostly on `screen`. See `visibleWindows`.
+    public func visibleWindows(on screen: Screen) -> [Window] {
+        DependencyTracker.shared.recordRead(.collection(.visibleWindows))
+        return delegate.visibleWindows.windows(on: screen.delegate).compactMap {
+            Window(delegate: $0)
+        }
+    }
+}
+
+extension Application {
+    /// The windows of the application that are currently visible on a screen. See
+    /// `State.visibleWindows`.
+    public var visibleWindows: [Window] {
+        DependencyTracker.shared.recordRead(.collection(.visibleWindows))
+        return swindlerState.delegate.visibleWindows.windows(ofProcess: processIdentifier)
+            .map { Window(delegate: $0, application: self) }
+    }
+}
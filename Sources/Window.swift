@@ -70,6 +70,69 @@ public final class Window {
 
     /// Whether the window is fullscreen or not.
     public var isFullscreen: WriteableProperty<OfType<Bool>> { return delegate.isFullscreen }
+
+    /// Whether the window is the main window of its application.
+    ///
+    /// This is derived from `Application.mainWindow` rather than read from the window, so it costs
+    /// no requests. Changes are reported with `WindowIsMainChangedEvent`. To make the window main,
+    /// set `Application.mainWindow`.
+    public var isMain: Bool { return application.mainWindow.value == self }
+
+    /// Whether the window is the focused (key) window of its application, the one currently
+    /// accepting keyboard input.
+    ///
+    /// This is derived from `Application.focusedWindow`; changes are reported with
+    /// `WindowIsFocusedChangedEvent`.
+    public var isFocused: Bool { return application.focusedWindow.value == self }
+
+    /// The accessibility subrole of the window (for example, "AXStandardWindow" or "AXDialog"), if
+    /// it has one. This is read when the window is first seen and does not change.
+    public var subrole: String? { return delegate.subrole }
+
+    /// Applies several changes to the window as one operation.
+    ///
+    /// The changes are written in an order that lets each take effect: the window is unminimized
+    /// and taken out of fullscreen before it is moved, and minimized or put into fullscreen after.
+    /// The window's attributes are then read back in a single request, and events are emitted for
+    /// everything that changed. As with `set`, events are internal unless the window ended up
+    /// different from what was requested.
+    ///
+    /// If `makeMain` is set, the window is made the main window of its application last. This is a
+    /// separate request made after the others complete, so other requests on the window may run in
+    /// between, and the resulting `ApplicationMainWindowChangedEvent` is reported like any other
+    /// `Application.mainWindow` write.
+    ///
+    /// The events of one call are not tagged as belonging together; they can only be told apart
+    /// from other events by being internal.
+    ///
+    /// - returns: A promise that resolves once the changes are written and read back.
+    /// - throws: `PropertyError` (via Promise)
+    public func apply(changes: WindowChanges) -> Promise<Void> {
+        return delegate.apply(changes).then { () -> Promise<Void> in
+            guard changes.makeMain else { return .value(()) }
+            return self.application.mainWindow.set(self).asVoid()
+        }
+    }
+}
+
+/// A set of changes to make to a window with `Window.apply(changes:)`. Properties left `nil` are
+/// not changed.
+public struct WindowChanges {
+    public var frame: CGRect?
+    public var isMinimized: Bool?
+    public var isFullscreen: Bool?
+    /// Whether to make the window the main window of its application.
+    public var makeMain: Bool
+
+    public init(frame: CGRect? = nil,
+                isMinimized: Bool? = nil,
+                isFullscreen: Bool? = nil,
+                makeMain: Bool = false) {
+        self.frame = frame
+        self.isMinimized = isMinimized
+        self.isFullscreen = isFullscreen
+        self.makeMain = makeMain
+    }
 }
 
 public func ==(lhs: Window, rhs: Window) -> Bool {
@@ -116,6 +179,13 @@ protocol WindowDelegate: AnyObject {
     var isMinimized: WriteableProperty<OfType<Bool>>! { get }
     var isFullscreen: WriteableProperty<OfType<Bool>>! { get }
 
+    var subrole: String? { get }
+
+    var extensions: ExtensionStorage { get set }
+
+    /// Writes the window attributes in `changes`. `makeMain` is handled by `Window`.
+    func apply(_ changes: WindowChanges) -> Promise<Void>
+
     func equalTo(_ other: WindowDelegate) -> Bool
 }
 
@@ -135,94 +205,123 @@ final class OSXWindowDelegate<
 
     fileprivate(set) var isValid: Bool = true
 
-    fileprivate var watchedAxProperties: [AXSwift.AXNotification: [PropertyType]]!
-
     weak var appDelegate: ApplicationDelegate?
 
+    // Shared by all the window's properties, to keep windows small. This is a narrower change than
+    // a packed per-window record, and it has costs: every request on the window is serialized, so
+    // a title refresh waits behind a frame write, and a poll or prefetch skips all of the window's
+    // properties while any request on it is in flight (see `Property.update(fromPolled:)`).
+    private let locks: PropertyLocks
+
     var frame: WriteableProperty<OfType<CGRect>>!
-    var size: SizeProperty!
     var title: Property<OfDefaultedType<String>>!
     var isMinimized: WriteableProperty<OfType<Bool>>!
     var isFullscreen: WriteableProperty<OfType<Bool>>!
 
+    // Derived entirely from `frame`, so it's only created if someone asks for it.
+    private var size_: SizeProperty?
+    var size: SizeProperty! {
+        locks.backingStore.lock()
+        defer { locks.backingStore.unlock() }
+        if size_ == nil {
+            // SizeProperty reads its initial value from the frame, so the delegate's initial
+            // attribute values aren't needed.
+            let sizeDelegate = AXPropertyDelegate<CGSize, UIElement>(
+                axElement, .size, frame.initialized.map { [:] }, activity: locks.activity)
+            size_ = SizeProperty(sizeDelegate, notifier: self, frame: frame)
+        }
+        return size_
+    }
+
+    fileprivate(set) var subrole: String?
+
+    // With lazy properties, the attributes read when a lazy property is first needed.
+    // Exposed for testing only.
+    let lazyAttributes: LazyAttributes?
+
+    var extensions = ExtensionStorage()
+
+    // When the last notification for the window arrived, for detecting missed notifications.
+    fileprivate var lastNotificationDate: Date?
+
     private init(_ appDelegate: ApplicationDelegate,
                  _ notifier: EventNotifier?,
                  _ axElement: UIElement,
                  _ observer: Observer,
-                 _ systemScreens: SystemScreenDelegate) throws {
+                 _ systemScreens: SystemScreenDelegate,
+                 _ lazyProperties: Bool) throws {
         self.appDelegate = appDelegate
         self.notifier = notifier
         self.axElement = axElement
+        let activity = appDelegate.activity
+        locks = PropertyLocks(activity: activity)
 
         // Create a promise for the attribute dictionary we'll get from getMultipleAttributes.
         let (initPromise, seal) = Promise<[AXSwift.Attribute: Any]>.pending()
 
+        // Title events need the old title, so lazy properties are only worth it if nobody is
+        // listening for them yet.
+        if lazyProperties && notifier?.hasHandlers(for: WindowTitleChangedEvent.self) != true {
+            lazyAttributes = LazyAttributes(lazyWindowAttributes,
+                                            forElement: axElement,
+                                            activity: activity)
+        } else {
+            lazyAttributes = nil
+        }
+        let lazyInitPromise = lazyAttributes?.fetched ?? initPromise
+
         // Initialize all properties.
-        let frameDelegate = FramePropertyDelegate(axElement, initPromise, systemScreens)
+        let frameDelegate = FramePropertyDelegate(axElement, initPromise, systemScreens, activity)
         frame = WriteableProperty(
             frameDelegate,
             withEvent: WindowFrameChangedEvent.self,
             receivingObject: Window.self,
-            notifier: self)
-        size = SizeProperty(
-            AXPropertyDelegate(axElement, .size, initPromise),
             notifier: self,
-            frame: frame)
+            locks: locks)
         title = Property(
-            AXPropertyDelegate(axElement, .title, initPromise),
+            AXPropertyDelegate(axElement, .title, lazyInitPromise, activity: activity),
             withEvent: WindowTitleChangedEvent.self,
             receivingObject: Window.self,
-            notifier: self)
+            notifier: self,
+            locks: locks,
+            lazily: lazyAttributes.map { LazyInitialization(attributes: $0, placeholder: "") })
         isMinimized = WriteableProperty(
-            AXPropertyDelegate(axElement, .minimized, initPromise),
+            AXPropertyDelegate(axElement, .minimized, initPromise, activity: activity),
             withEvent: WindowMinimizedChangedEvent.self,
             receivingObject: Window.self,
-            notifier: self)
+            notifier: self,
+            locks: locks)
         isFullscreen = WriteableProperty(
-            AXPropertyDelegate(axElement, .fullScreen, initPromise),
-            notifier: self)
-
-        let axProperties: [PropertyType] = [
-            size,
-            title,
-            isMinimized,
-            isFullscreen
-        ]
-        let allProperties: [PropertyType] = axProperties + [
-            frame
-        ]
-
-        // Map notifications on this element to the corresponding property.
-        // Note that `size` implicitly updates every time `frame` updates, so it is not listed here.
-        watchedAxProperties = [
-            .moved: [frame],
-            .resized: [frame, isFullscreen],
-            .titleChanged: [title],
-            .windowMiniaturized: [isMinimized],
-            .windowDeminiaturized: [isMinimized]
-        ]
+            AXPropertyDelegate(axElement, .fullScreen, lazyInitPromise, activity: activity),
+            notifier: self,
+            locks: locks,
+            lazily: lazyAttributes.map { LazyInitialization(attributes: $0, placeholder: false) })
+
+        // Lazy properties initialize on their own schedule, so the window doesn't wait for them.
+        let allProperties: [PropertyType] = lazyAttributes == nil
+            ? [frame, title, isMinimized, isFullscreen]
+            : [frame, isMinimized]
 
         // Start watching for notifications.
-        let notifications = watchedAxProperties.keys + [
-            .uiElementDestroyed
-        ]
+        let notifications = windowNotifications
         let watched = watchWindowElement(axElement,
                                          observer: observer,
                                          notifications: notifications)
 
         // Fetch attribute values.
-        let attributes = axProperties.map {($0.delegate as! AXPropertyDelegateType).attribute} + [
-            .frame,
-            .subrole
-        ]
         fetchAttributes(
-            attributes, forElement: axElement, after: watched, seal: seal
+            lazyAttributes == nil ? windowAttributes : eagerWindowAttributes,
+            forElement: axElement,
+            activity: activity,
+            after: watched,
+            seal: seal
         )
 
         // Ignore windows with the "AXUnknown" role. This (undocumented) role shows up in several
         // places, including Chrome tooltips and OS X fullscreen transitions.
         let subroleChecked = initPromise.done { attributeValues in
-            if attributeValues[.subrole] as! String? == "AXUnknown" {
+            self.subrole = attributeValues[.subrole] as! String?
+            if self.subrole == "AXUnknown" {
                 log.trace("Window \(axElement) has subrole AXUnknown, unwatching")
                 self.unwatchWindowElement(
                     axElement, observer: observer, notifications: notifications
@@ -241,7 +340,8 @@ final class OSXWindowDelegate<
                                     notifications: [AXNotification]) -> Promise<Void> {
         return Promise<Void>.value(()).done(on: .global()) {
             for notification in notifications {
-                try traceRequest(self.axElement, "addNotification", notification) {
+                try traceRequest(self.axElement, "addNotification", notification,
+                                 activity: self.locks.activity) {
                     try observer.addNotification(notification, forElement: self.axElement)
                 }
             }
@@ -253,7 +353,8 @@ final class OSXWindowDelegate<
                                       notifications: [AXNotification]) -> Promise<Void> {
         return Promise<Void>.value(()).done(on: .global()) {
             for notification in notifications {
-                try traceRequest(self.axElement, "removeNotification", notification) {
+                try traceRequest(self.axElement, "removeNotification", notification,
+                                 activity: self.locks.activity) {
                     try observer.removeNotification(notification, forElement: self.axElement)
                 }
             }
@@ -277,25 +378,177 @@ extension OSXWindowDelegate {
         notifier: EventNotifier?,
         axElement: UIElement,
         observer: Observer,
-        systemScreens: SystemScreenDelegate
+        systemScreens: SystemScreenDelegate,
+        lazyProperties: Bool = false
     ) -> Promise<OSXWindowDelegate> {
         return firstly { () -> Promise<OSXWindowDelegate> in // capture thrown errors in promise
             let window = try OSXWindowDelegate(
-                appDelegate, notifier, axElement, observer, systemScreens)
+                appDelegate, notifier, axElement, observer, systemScreens, lazyProperties)
             return window.initialized.map { window }
         }
     }
 
+    /// Starts fetching the window's lazy properties, if it has any that haven't been fetched.
+    func requestLazyProperties() {
+        lazyAttributes?.request()
+    }
+
     func handleEvent(_ event: AXSwift.AXNotification, observer: Observer) {
+        lastNotificationDate = Date()
         switch event {
+        // Keep in sync with `windowNotifications`.
+        // Note that `size` implicitly updates every time `frame` updates, so it is not listed here.
         case .uiElementDestroyed:
             isValid = false
+        case .moved:
+            frame.refresh()
+        case .resized:
+            frame.refresh()
+            isFullscreen.refresh()
+        case .titleChanged:
+            title.refresh()
+        case .windowMiniaturized, .windowDeminiaturized:
+            isMinimized.refresh()
         default:
-            if let properties = watchedAxProperties[event] {
-                properties.forEach { $0.issueRefresh() }
-            } else {
-                log.debug("Unknown event on \(self): \(event)")
+            log.debug("Unknown event on \(self): \(event)")
+        }
+    }
+}
+
+/// Interface used by the invalid window reaper.
+extension OSXWindowDelegate {
+    /// Refreshes the properties of a window that a probe showed still exists, since they may have
+    /// missed changes in the meantime, and marks the window valid again if they could all be read.
+    /// Returns whether it did.
+    func revalidate() -> Guarantee<Bool> {
+        let refreshes = [frame.refresh().asVoid(),
+                         title.refresh().asVoid(),
+                         isMinimized.refresh().asVoid(),
+                         isFullscreen.refresh().asVoid()]
+        return when(fulfilled: refreshes).map { () -> Bool in
+            self.isValid = true
+            return true
+        }.recover { _ in .value(false) }
+    }
+}
+
+/// Multi-attribute writes.
+extension OSXWindowDelegate {
+    func apply(_ changes: WindowChanges) -> Promise<Void> {
+        typealias Change<T> = (oldValue: T, newValue: T)?
+        let request = locks.activity?.queued(refresh: false)
+        return initialized.map(on: .global()) {
+            () -> (Change<CGRect>, Change<Bool>, Change<Bool>) in
+
+            // All of the window's properties share one request lock, so this excludes other reads
+            // and writes for the whole sequence.
+            self.locks.request.lock()
+            defer { self.locks.request.unlock() }
+            request?.dequeued()
+
+            if changes.isMinimized == false {
+                try self.isMinimized.delegate_.writeValue(false)
+            }
+            if changes.isFullscreen == false {
+                try self.isFullscreen.delegate_.writeValue(false)
+            }
+            if let frame = changes.frame {
+                try self.frame.delegate_.writeValue(frame)
+            }
+            if changes.isFullscreen == true {
+                try self.isFullscreen.delegate_.writeValue(true)
+            }
+            if changes.isMinimized == true {
+                try self.isMinimized.delegate_.writeValue(true)
+            }
+
+            let attributes: [AXSwift.Attribute: Any]
+            do {
+                attributes = try traceRequest(self.axElement, "getMultipleAttributes",
+                                              windowPollAttributes,
+                                              activity: self.locks.activity) {
+                    try self.axElement.getMultipleAttributes(windowPollAttributes)
+                }
+            } catch AXError.cannotComplete {
+                // If messaging timeout unspecified, we'll pass -1.
+                var time = UIElement.globalMessagingTimeout
+                if time == 0 {
+                    time = -1.0
+                }
+                throw PropertyError.timeout(time: TimeInterval(time))
+            } catch AXError.invalidUIElement {
+                throw PropertyError.invalidObject(cause: AXError.invalidUIElement)
+            } catch {
+                // The window may still exist, so this doesn't mark it invalid.
+                throw PropertyError.failure(cause: error)
+            }
+            return (try self.frame.storeReadback(from: attributes),
+                    try self.isMinimized.storeReadback(from: attributes),
+                    try self.isFullscreen.storeReadback(from: attributes))
+        }.done { frame, isMinimized, isFullscreen in
+            // Back on main thread.
+            if let frame = frame {
+                self.frame.notifyReadback(oldValue: frame.oldValue,
+                                          newValue: frame.newValue,
+                                          desired: changes.frame)
+            }
+            if let isMinimized = isMinimized {
+                self.isMinimized.notifyReadback(oldValue: isMinimized.oldValue,
+                                                newValue: isMinimized.newValue,
+                                                desired: changes.isMinimized)
+            }
+            if let isFullscreen = isFullscreen {
+                self.isFullscreen.notifyReadback(oldValue: isFullscreen.oldValue,
+                                                 newValue: isFullscreen.newValue,
+                                                 desired: changes.isFullscreen)
+            }
+        }.tap { result in
+            request?.completed()
+            if case .rejected(let error) = result, case PropertyError.invalidObject = error {
+                self.notifyInvalid()
+            }
+        }
+    }
+}
+
+/// Polling, for applications that don't reliably send notifications.
+extension OSXWindowDelegate {
+    /// Reads all watched attributes in a single request and updates the properties that changed,
+    /// emitting events for them as if a notification had arrived.
+    ///
+    /// A change counts as a missed notification if no notification arrived for the window within
+    /// `notificationGracePeriod` of the poll.
+    ///
+    /// - parameter qos: The quality of service of the background request.
+    func pollForChanges(qos: DispatchQoS.QoSClass = .default) -> Promise<PollOutcome> {
+        let start = Date()
+        let properties: [PropertyPollable] = [frame, title, isMinimized, isFullscreen]
+        // Anything stored after this point is at least as fresh as what the poll reads.
+        let sequences = properties.map { $0.changeSequence }
+        return Promise.value(()).map(on: .global(qos: qos)) { () -> [AXSwift.Attribute: Any] in
+            try traceRequest(self.axElement, "getMultipleAttributes", windowPollAttributes,
+                             activity: self.locks.activity) {
+                try self.axElement.getMultipleAttributes(windowPollAttributes)
+            }
+        }.map { attributes -> PollOutcome in
+            // Back on main thread.
+            guard self.isValid else { return PollOutcome(requests: 1) }
+            var changed = false
+            for (property, sequence) in zip(properties, sequences)
+                where property.update(fromPolled: attributes, ifUnchangedSince: sequence) {
+                changed = true
             }
+            let notified = self.lastNotificationDate.map {
+                $0 > start.addingTimeInterval(-notificationGracePeriod)
+            } ?? false
+            return PollOutcome(requests: 1,
+                               changedWindows: changed ? 1 : 0,
+                               missedNotifications: changed && !notified ? 1 : 0)
+        }.recover { error -> Promise<PollOutcome> in
+            if case AXError.invalidUIElement = error {
+                self.notifyInvalid()
+            }
+            return .value(PollOutcome(requests: 1))
         }
     }
 }
@@ -317,10 +570,58 @@ extension OSXWindowDelegate: PropertyNotifier {
     }
 
     func notifyInvalid() {
+        guard isValid else { return }
         isValid = false
+        appDelegate?.windowDidBecomeInvalid()
     }
 }
 
+// The notifications watched on each window element, handled in `handleEvent`.
+private let windowNotifications: [AXNotification] = [
+    .moved,
+    .resized,
+    .titleChanged,
+    .windowMiniaturized,
+    .windowDeminiaturized,
+    .uiElementDestroyed
+]
+
+// A change found by polling counts as notified if a notification for the window arrived this long
+// before the poll started, or any time after.
+private let notificationGracePeriod: TimeInterval = 1
+
+// The attributes read when polling a window, covering the properties updated by notifications.
+private let windowPollAttributes: [AXSwift.Attribute] = [
+    .title,
+    .minimized,
+    .fullScreen,
+    .frame
+]
+
+// The attributes fetched when a window is first seen, used to initialize its properties.
+private let windowAttributes: [AXSwift.Attribute] = [
+    .title,
+    .minimized,
+    .fullScreen,
+    .frame,
+    .subrole
+]
+
+// With lazy properties, the attributes fetched when a window is first seen: its frame and
+// minimized state, which the visible window index needs, and the subrole, which decides whether the
+// window is tracked at all.
+private let eagerWindowAttributes: [AXSwift.Attribute] = [
+    .minimized,
+    .frame,
+    .subrole
+]
+
+// With lazy properties, the attributes fetched together when one of them is first needed.
+private let lazyWindowAttributes: [AXSwift.Attribute] = [
+    .title,
+    .fullScreen
+]
+
 // MARK: PropertyDelegates
 
 /// PropertyAdapter that inverts the y-axis of the point value.
@@ -338,10 +639,16 @@ private final class FramePropertyDelegate<UIElement: UIElementType>: PropertyDel
 
     typealias InitDict = [AXSwift.Attribute: Any]
 
-    init(_ element: UIElement, _ initPromise: Promise<InitDict>, _ screens: SystemScreenDelegate) {
-        frame = AXPropertyDelegate<CGRect, UIElement>(element, .frame, initPromise)
-        pos = AXPropertyDelegate<CGPoint, UIElement>(element, .position, initPromise)
-        size = AXPropertyDelegate<CGSize, UIElement>(element, .size, initPromise)
+    init(_ element: UIElement,
+         _ initPromise: Promise<InitDict>,
+         _ screens: SystemScreenDelegate,
+         _ activity: ProcessActivity?) {
+        frame = AXPropertyDelegate<CGRect, UIElement>(element, .frame, initPromise,
+                                                      activity: activity)
+        pos = AXPropertyDelegate<CGPoint, UIElement>(element, .position, initPromise,
+                                                     activity: activity)
+        size = AXPropertyDelegate<CGSize, UIElement>(element, .size, initPromise,
+                                                     activity: activity)
         systemScreens = screens
     }
 
@@ -362,6 +669,10 @@ private final class FramePropertyDelegate<UIElement: UIElementType>: PropertyDel
         }
     }
 
+    func readValue(from attributes: InitDict) -> T? {
+        return frame.readValue(from: attributes).map { invert($0) }
+    }
+
     private func invert(_ rect: CGRect) -> CGRect {
         let inverted = CGPoint(x: rect.minX, y: systemScreens.maxY - rect.maxY)
         return CGRect(origin: inverted, size: rect.size)
@@ -383,7 +694,7 @@ final class SizeProperty: WriteableProperty<OfType<CGSize>> {
         _ delegate: Impl, notifier: Notifier, frame: WriteableProperty<OfType<CGRect>>
     ) where Impl.T == NonOptionalType {
         self.frame = frame
-        super.init(delegate, notifier: notifier)
+        super.init(delegate, notifier: notifier, locks: frame.locks)
     }
 
     override func initialize<Impl: PropertyDelegate>(_ delegate: Impl) -> Promise<Void> {
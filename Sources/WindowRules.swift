@@ -0,0 +1,238 @@
+import Cocoa
+
+// MARK: - WindowRule
+
+/// A rule that selects windows by their properties.
+///
+/// Every criterion that is set must match for the rule to match. A rule with no criteria matches
+/// every window.
+public struct WindowRule {
+    /// A name for the rule, for your own bookkeeping.
+    public var name: String
+    /// The bundle identifier of the window's application.
+    public var bundleIdentifier: String?
+    /// A regular expression that must match some part of the window title.
+    public var titlePattern: String?
+    /// The accessibility subrole of the window, e.g. "AXStandardWindow" or "AXDialog".
+    public var subrole: String?
+    /// The smallest size (inclusive) the window may have in either dimension.
+    public var minimumSize: CGSize?
+    /// The largest size (inclusive) the window may have in either dimension.
+    public var maximumSize: CGSize?
+
+    public init(name: String,
+                bundleIdentifier: String? = nil,
+                titlePattern: String? = nil,
+                subrole: String? = nil,
+                minimumSize: CGSize? = nil,
+                maximumSize: CGSize? = nil) {
+        self.name = name
+        self.bundleIdentifier = bundleIdentifier
+        self.titlePattern = titlePattern
+        self.subrole = subrole
+        self.minimumSize = minimumSize
+        self.maximumSize = maximumSize
+    }
+}
+
+// MARK: - WindowRuleSet
+
+/// An ordered set of `WindowRule`s, compiled for fast matching.
+///
+/// Rules are indexed by bundle identifier, so only the rules that can apply to a window's
+/// application are considered, and title patterns are compiled once up front. Checks are ordered
+/// from cheapest to most expensive, with the title pattern last.
+public final class WindowRuleSet {
+    /// The rules, in the order they were given.
+    public let rules: [WindowRule]
+
+    fileprivate struct CompiledRule {
+        let index: Int
+        let title: NSRegularExpression?
+        let subrole: String?
+        let minimumSize: CGSize?
+        let maximumSize: CGSize?
+    }
+
+    private let rulesByBundleID: [String: [CompiledRule]]
+    private let rulesForAnyBundleID: [CompiledRule]
+
+    /// Whether any rule depends on the window title.
+    let dependsOnTitle: Bool
+    /// Whether any rule depends on the window size.
+    let dependsOnSize: Bool
+
+    /// Compiles the rules.
+    ///
+    /// - throws: An error if any title pattern is not a valid regular expression.
+    public init(_ rules: [WindowRule]) throws {
+        self.rules = rules
+
+        var regexes: [String: NSRegularExpression] = [:]
+        var byBundleID: [String: [CompiledRule]] = [:]
+        var anyBundleID: [CompiledRule] = []
+        for (index, rule) in rules.enumerated() {
+            var title: NSRegularExpression?
+            if let pattern = rule.titlePattern {
+                // Many rules tend to share the same pattern; only compile it once.
+                if regexes[pattern] == nil {
+                    regexes[pattern] = try NSRegularExpression(pattern: pattern)
+                }
+                title = regexes[pattern]
+            }
+            let compiled = CompiledRule(index: index,
+                                        title: title,
+                                        subrole: rule.subrole,
+                                        minimumSize: rule.minimumSize,
+                                        maximumSize: rule.maximumSize)
+            if let bundleID = rule.bundleIdentifier {
+                byBundleID[bundleID, default: []].append(compiled)
+            } else {
+                anyBundleID.append(compiled)
+            }
+        }
+
+        rulesByBundleID = byBundleID
+        rulesForAnyBundleID = anyBundleID
+        dependsOnTitle = rules.contains { $0.titlePattern != nil }
+        dependsOnSize = rules.contains { $0.minimumSize != nil || $0.maximumSize != nil }
+    }
+
+    /// Returns the rules that match `window`, in the order they were given.
+    public func matches(_ window: Window) -> [WindowRule] {
+        return matchingIndices(window).map { rules[$0] }
+    }
+
+    /// Returns the indices (into `rules`) of the rules that match `window`, in ascending order.
+    func matchingIndices(_ window: Window) -> [Int] {
+        let specific: [CompiledRule]
+        if rulesByBundleID.isEmpty {
+            specific = []
+        } else {
+            specific = window.application.bundleIdentifier.flatMap { rulesByBundleID[$0] } ?? []
+        }
+        if specific.isEmpty && rulesForAnyBundleID.isEmpty {
+            return []
+        }
+
+        // Read each property at most once, and only if needed.
+        var size: CGSize?
+        var title: String?
+        func check(_ rule: CompiledRule) -> Bool {
+            if let subrole = rule.subrole, subrole != window.subrole {
+                return false
+            }
+            if rule.minimumSize != nil || rule.maximumSize != nil {
+                if size == nil { size = window.size.value }
+                if let min = rule.minimumSize,
+                   size!.width < min.width || size!.height < min.height {
+                    return false
+                }
+                if let max = rule.maximumSize,
+                   size!.width > max.width || size!.height > max.height {
+                    return false
+                }
+            }
+            if let regex = rule.title {
+                if title == nil { title = window.title.value }
+                let range = NSRange(title!.startIndex..<title!.endIndex, in: title!)
+                if regex.firstMatch(in: title!, options: [], range: range) == nil {
+                    return false
+                }
+            }
+            return true
+        }
+
+        // Merge the two lists, which are each sorted by index, to preserve rule order.
+        var result: [Int] = []
+        var i = 0, j = 0
+        while i < specific.count || j < rulesForAnyBundleID.count {
+            let rule: CompiledRule
+            if j == rulesForAnyBundleID.count
+                || (i < specific.count && specific[i].index < rulesForAnyBundleID[j].index) {
+                rule = specific[i]
+                i += 1
+            } else {
+                rule = rulesForAnyBundleID[j]
+                j += 1
+            }
+            if check(rule) {
+                result.append(rule.index)
+            }
+        }
+        return result
+    }
+}
+
+// MARK: - WindowRuleMatcher
+
+/// Keeps track of which rules in a `WindowRuleSet` match each window.
+///
+/// Each window is evaluated once when it is created (or when the matcher is created, for existing
+/// windows). It is only re-evaluated when a property that some rule depends on changes: the title
+/// if any rule has a title pattern, and the size if any rule has a size constraint.
+public final class WindowRuleMatcher {
+    public let ruleSet: WindowRuleSet
+
+    private let onChange: (Window, [WindowRule]) -> Void
+    // Matches are stored on the window itself, so they go away with it. They are removed when the
+    // matcher goes away first.
+    private let matchesKey = ExtensionKey<[Int]>()
+    private weak var state: State?
+
+    /// Creates a matcher and evaluates all known windows.
+    ///
+    /// - parameter onChange: Called on the main thread whenever the set of rules matching a window
+    ///                       changes, including when a new window matches at least one rule.
+    public init(ruleSet: WindowRuleSet,
+                state: State,
+                onChange: @escaping (Window, [WindowRule]) -> Void) {
+        self.ruleSet = ruleSet
+        self.onChange = onChange
+        self.state = state
+
+        state.on(label: "WindowRuleMatcher") { [weak self] (event: WindowCreatedEvent) in
+            self?.evaluate(event.window)
+        }
+        if ruleSet.dependsOnTitle {
+            state.on(label: "WindowRuleMatcher") { [weak self] (event: WindowTitleChangedEvent) in
+                self?.evaluate(event.window)
+            }
+        }
+        if ruleSet.dependsOnSize {
+            state.on(label: "WindowRuleMatcher") { [weak self] (event: WindowFrameChangedEvent) in
+                guard event.oldValue.size != event.newValue.size else { return }
+                self?.evaluate(event.window)
+            }
+        }
+
+        for window in state.knownWindows {
+            evaluate(window)
+        }
+    }
+
+    deinit {
+        removeExtension(matchesKey, fromWindowsOf: state)
+    }
+
+    /// The rules that match `window`, in the order they were given.
+    public func matchingRules(for window: Window) -> [WindowRule] {
+        if let indices = window[matchesKey] {
+            return indices.map { ruleSet.rules[$0] }
+        }
+        let indices = ruleSet.matchingIndices(window)
+        window[matchesKey] = indices
+        return indices.map { ruleSet.rules[$0] }
+    }
+
+    private func evaluate(_ window: Window) {
+        assert(Thread.current.isMainThread)
+        guard window.isValid else { return }
+        let indices = ruleSet.matchingIndices(window)
+        let old = window[matchesKey] ?? []
+        window[matchesKey] = indices
+        if old != indices {
+            onChange(window, indices.map { ruleSet.rules[$0] })
+        }
+    }
+}
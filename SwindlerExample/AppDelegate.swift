@@ -61,21 +61,12 @@ class AppDelegate: NSObject, NSApplicationDelegate {
         swindler.on { (event: WindowDestroyedEvent) in
             print("window destroyed: \(event.window.title.value)")
         }
-        swindler.on { (event: ApplicationMainWindowChangedEvent) in
-            print("new main window: \(String(describing: event.newValue?.title.value)).",
-                  "[old: \(String(describing: event.oldValue?.title.value))]")
-            self.frontmostWindowChanged()
+        swindler.on { (event: FocusChangedEvent) in
+            print("new frontmost app: \(event.newApplication?.bundleIdentifier ?? "unknown").",
+                  "[old: \(event.oldApplication?.bundleIdentifier ?? "unknown")]")
+            print("new frontmost window: \(String(describing: event.newWindow?.title.value))",
+                  "(\(Int(event.latency * 1000))ms)")
         }
-        swindler.on { (event: FrontmostApplicationChangedEvent) in
-            print("new frontmost app: \(event.newValue?.bundleIdentifier ?? "unknown").",
-                  "[old: \(event.oldValue?.bundleIdentifier ?? "unknown")]")
-            self.frontmostWindowChanged()
-        }
-    }
-
-    private func frontmostWindowChanged() {
-        let window = swindler.frontmostApplication.value?.mainWindow.value
-        print("new frontmost window: \(String(describing: window?.title.value))")
     }
 
     func applicationWillTerminate(_ aNotification: Notification) {
@@ -6,6 +6,30 @@ import Nimble
 import AXSwift
 import PromiseKit
 
+// Answers role reads, but fails every other read with `AXError.failure` once `failReads` is set.
+private class UnreadableWindowElement: TestWindowElement {
+    var failReads = false
+    private let lock = NSLock()
+    private var roleReads_ = 0
+
+    var roleReads: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return roleReads_
+    }
+
+    override func attribute<T>(_ attr: Attribute) throws -> T? {
+        if attr == .role {
+            lock.lock()
+            roleReads_ += 1
+            lock.unlock()
+        } else if failReads {
+            throw AXError.failure
+        }
+        return try super.attribute(attr)
+    }
+}
+
 class OSXApplicationDelegateInitializeSpec: QuickSpec {
     override func spec() {
 
@@ -508,6 +532,72 @@ class OSXApplicationDelegateSpec: QuickSpec {
                 }
 
             }
+
+            context("when a window answers probes but can't be read") {
+                it("backs off instead of probing it every time") {
+                    let element = UnreadableWindowElement(forApp: appElement)
+                    createWindow(emitEvent: false, windowElement: element)
+                    initializeApp()
+                    appDelegate.reapDelay = 0.2
+                    let window = appDelegate.knownWindows.first!
+                    element.failReads = true
+                    waitUntil { done in
+                        window.title.refresh().ensure { done() }.cauterize()
+                    }
+                    expect(window.isValid).to(beFalse())
+                    let readsBefore = element.roleReads
+
+                    // Without backoff, this would be a probe every 0.2s.
+                    waitUntil(timeout: 3) { done in
+                        DispatchQueue.main.asyncAfter(deadline: .now() + 1.5) { done() }
+                    }
+                    expect(window.isValid).to(beFalse())
+                    let probes = element.roleReads - readsBefore
+                    expect(probes).to(beGreaterThan(0))
+                    expect(probes).to(beLessThanOrEqualTo(4))
+                }
+            }
+
+            context("when a window becomes invalid without being destroyed") {
+                var windowElement: TestWindowElement!
+                var window: WindowDelegate!
+                beforeEach {
+                    windowElement = createWindow(emitEvent: false)
+                    initializeApp()
+                    appDelegate.reapDelay = 0.2
+                    window = appDelegate.knownWindows.first!
+                    windowElement.throwInvalid = true
+                    waitUntil { done in
+                        window.title.refresh().ensure { done() }.cauterize()
+                    }
+                    expect(window.isValid).to(beFalse())
+                }
+
+                it("removes the window once a probe confirms it is gone") {
+                    expect(getWindowElements(appDelegate.knownWindows))
+                        .toEventuallyNot(contain(windowElement))
+                    let event = notifier.expectEvent(WindowDestroyedEvent.self)
+                    expect(getWindowElementForWindow(event?.window)).to(equal(windowElement))
+                    expect(appDelegate.health.reapedWindows).to(equal(1))
+                }
+
+                it("keeps the window if it still answers") {
+                    windowElement.throwInvalid = false
+                    expect(window.isValid).toEventually(beTrue())
+                    expect(getWindowElements(appDelegate.knownWindows)).to(contain(windowElement))
+                    expect(notifier.getEventOfType(WindowDestroyedEvent.self)).to(beNil())
+                    expect(appDelegate.health.reapedWindows).to(equal(0))
+                }
+
+                it("doesn't probe over the IPC budget") {
+                    let budget = stubStateDelegate.polling.ipcBudget
+                    budget.burst = 0
+                    budget.requestsPerSecond = 0
+                    expect(budget.deniedRequests).toEventually(beGreaterThan(0))
+                    expect(getWindowElements(appDelegate.knownWindows)).to(contain(windowElement))
+                    expect(appDelegate.health.reapedWindows).to(equal(0))
+                }
+            }
         }
 
         // mainWindow is quite a bit more complicated than other properties, so we explicitly test
@@ -556,6 +646,40 @@ class OSXApplicationDelegateSpec: QuickSpec {
                     }
                 }
 
+                it("emits a WindowIsMainChangedEvent for the new main window") {
+                    if let event = notifier.expectEvent(WindowIsMainChangedEvent.self) {
+                        expect(getWindowElementForWindow(event.window)).to(equal(windowElement))
+                        expect(event.external).to(beTrue())
+                        expect(event.oldValue).to(beFalse())
+                        expect(event.newValue).to(beTrue())
+                        expect(event.window.isMain).to(beTrue())
+                    }
+                }
+
+                context("and then another window becomes main") {
+                    var otherElement: TestWindowElement!
+                    beforeEach {
+                        notifier.waitUntilEvent(WindowIsMainChangedEvent.self)
+                        otherElement = createWindow()
+                        windowElement.attrs[.main] = false
+                        otherElement.attrs[.main] = true
+                        appElement.attrs[.mainWindow] = otherElement
+                        observer.emit(.mainWindowChanged, forElement: otherElement)
+                    }
+
+                    it("emits a WindowIsMainChangedEvent for each window") {
+                        expect(notifier.getEventsOfType(WindowIsMainChangedEvent.self))
+                            .toEventually(haveCount(3))
+                        let events = notifier.getEventsOfType(WindowIsMainChangedEvent.self)
+                        expect(getWindowElementForWindow(events[1].window))
+                            .to(equal(windowElement))
+                        expect(events[1].newValue).to(beFalse())
+                        expect(events[1].window.isMain).to(beFalse())
+                        expect(getWindowElementForWindow(events[2].window)).to(equal(otherElement))
+                        expect(events[2].newValue).to(beTrue())
+                    }
+                }
+
                 // TODO: timeout on reading .role
             }
 
@@ -625,6 +749,27 @@ class OSXApplicationDelegateSpec: QuickSpec {
                 // TODO: timeout on reading .role
             }
 
+            context("when an update waiting for a new window is evicted") {
+                it("refreshes the value") {
+                    let windowElement = createWindow()
+                    expect(appDelegate.knownWindows).toEventually(haveCount(1))
+
+                    // The update for a window that never appears stays deferred...
+                    let unknownElement = TestWindowElement(forApp: appElement)
+                    windowElement.attrs[.main] = true
+                    appElement.attrs[.mainWindow] = windowElement
+                    observer.emit(.mainWindowChanged, forElement: unknownElement)
+                    expect(appDelegate.health.deferredWindowHandlers).toEventually(equal(1))
+                    expect(appDelegate.mainWindow.value).to(beNil())
+
+                    // ...until memory pressure drops it.
+                    expect(appDelegate.evictDeferredWindowHandlers(bytes: 1)).to(beGreaterThan(0))
+                    expect(appDelegate.health.deferredWindowHandlers).to(equal(0))
+                    expect(getWindowElementForWindow(appDelegate.mainWindow.value))
+                        .toEventually(equal(windowElement))
+                }
+            }
+
             context("when a window is assigned") {
 
                 var windowElement: TestWindowElement!
@@ -788,6 +933,15 @@ class OSXApplicationDelegateSpec: QuickSpec {
                     }
                 }
 
+                it("emits a WindowIsFocusedChangedEvent for the new focused window") {
+                    if let event = notifier.expectEvent(WindowIsFocusedChangedEvent.self) {
+                        expect(getWindowElementForWindow(event.window)).to(equal(windowElement))
+                        expect(event.oldValue).to(beFalse())
+                        expect(event.newValue).to(beTrue())
+                        expect(event.window.isFocused).to(beTrue())
+                    }
+                }
+
             }
         }
 
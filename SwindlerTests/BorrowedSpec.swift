@@ -0,0 +1,113 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class BorrowedSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .then {
+                        when(fulfilled: (0..<3).map { i in
+                            FakeWindowBuilder(parent: fakeApp).setTitle("window \(i)").build()
+                        })
+                    }
+                    .done { _ in done() }
+                    .cauterize()
+            }
+        }
+
+        describe("forEachWindow") {
+            it("visits the same windows as knownWindows") {
+                var titles: [String] = []
+                fakeState.state.forEachWindow { titles.append($0.title.value) }
+                expect(titles.sorted())
+                    .to(equal(fakeState.state.knownWindows.map { $0.title.value }.sorted()))
+            }
+
+            it("visits the windows of a single application") {
+                var count = 0
+                fakeApp.application.forEachWindow { _ in count += 1 }
+                expect(count).to(equal(3))
+            }
+
+            it("materializes windows") {
+                var windows: [Window] = []
+                fakeState.state.forEachWindow { windows.append($0.window!) }
+                expect(Set(windows.map { $0.title.value }))
+                    .to(equal(Set(fakeState.state.knownWindows.map { $0.title.value })))
+            }
+        }
+
+        describe("forEachApplication") {
+            it("visits running applications") {
+                var apps: [Application] = []
+                fakeState.state.forEachApplication { apps.append($0.application!) }
+                expect(apps).to(equal([fakeApp.application]))
+            }
+        }
+
+        describe("forEachScreen") {
+            it("visits screens") {
+                var frames: [CGRect] = []
+                fakeState.state.forEachScreen { frames.append($0.frame) }
+                expect(frames).to(equal(fakeState.state.screens.map { $0.frame }))
+            }
+        }
+
+        describe("benchmark") {
+            let windowCount = 500
+
+            beforeEach {
+                waitUntil(timeout: 10) { done in
+                    when(fulfilled: (0..<windowCount - 3).map { _ in
+                        FakeWindowBuilder(parent: fakeApp).build()
+                    }).done { _ in done() }.cauterize()
+                }
+            }
+
+            func traverse() -> CGFloat {
+                var area: CGFloat = 0
+                fakeState.state.forEachWindow { window in
+                    if !window.isMinimized.value {
+                        let size = window.frame.value.size
+                        area += size.width * size.height
+                    }
+                }
+                return area
+            }
+
+            it("traverses \(windowCount) windows without allocating") {
+                // Warm up, so one-time initialization isn't counted.
+                _ = traverse()
+
+                var area: CGFloat = 0
+                let allocations = countAllocations {
+                    for _ in 0..<60 {
+                        area += traverse()
+                    }
+                }
+                expect(area).to(beGreaterThan(0))
+                expect(allocations).to(equal(0))
+            }
+
+            it("allocates when using knownWindows") {
+                _ = fakeState.state.knownWindows
+                let allocations = countAllocations {
+                    _ = fakeState.state.knownWindows.count
+                }
+                expect(allocations).to(beGreaterThanOrEqualTo(windowCount))
+            }
+        }
+
+    }
+}
@@ -4,27 +4,61 @@ import PromiseKit
 
 class StubStateDelegate: StateDelegate {
     var runningApplications: [ApplicationDelegate] = []
+    func applications(bundleID: String) -> [ApplicationDelegate] {
+        return runningApplications.filter { $0.metadata.bundleIdentifier == bundleID }
+    }
     var frontmostApplication: WriteableProperty<OfOptionalType<Swindler.Application>>!
     var knownWindows: [WindowDelegate] = []
     var systemScreens: SystemScreenDelegate { return fakeScreens }
+    func forEachApplicationDelegate(_ body: (ApplicationDelegate) throws -> Void) rethrows {
+        try runningApplications.forEach(body)
+    }
+    func forEachWindowDelegate(_ body: (WindowDelegate) throws -> Void) rethrows {
+        try knownWindows.forEach(body)
+    }
     var notifier: EventNotifier = EventNotifier()
+    lazy var polling = PollingSupervisor(targets: { [] })
+    lazy var visibleWindows = VisibleWindowIndex(notifier: notifier, stateDelegate: self)
+    lazy var spaces = SpaceTracker(notifier: notifier,
+                                   observer: FakeSpaceObserver(),
+                                   stateDelegate: self)
+    var configuration = Configuration()
 
     var fakeScreens: FakeSystemScreenDelegate = FakeSystemScreenDelegate(screens: [])
 }
 
 class StubApplicationDelegate: ApplicationDelegate {
     var processIdentifier: pid_t!
-    var bundleIdentifier: String?
+    var metadata = ApplicationMetadata()
 
     var stateDelegate: StateDelegate? = StubStateDelegate()
 
     var knownWindows: [WindowDelegate] = []
+    func forEachWindowDelegate(_ body: (WindowDelegate) throws -> Void) rethrows {
+        try knownWindows.forEach(body)
+    }
 
     var mainWindow: WriteableProperty<OfOptionalType<Window>>!
     var focusedWindow: Property<OfOptionalType<Window>>!
     var isFrontmost: WriteableProperty<OfType<Bool>>!
     var isHidden: WriteableProperty<OfType<Bool>>!
 
+    var extensions = ExtensionStorage()
+
+    let activity = ProcessActivity()
+    var health: ApplicationHealth {
+        return activity.health(processIdentifier: processIdentifier ?? 0,
+                               bundleIdentifier: metadata.bundleIdentifier,
+                               deferredWindowHandlers: 0,
+                               reapedWindows: 0)
+    }
+
+    func windowDidBecomeInvalid() {}
+
+    func discoverWindows() -> Promise<(discovered: [WindowDelegate], listed: [WindowDelegate])> {
+        return .value((discovered: [], listed: knownWindows))
+    }
+
     func equalTo(_ other: ApplicationDelegate) -> Bool { return self === other }
 }
 
@@ -35,10 +69,14 @@ class StubWindowDelegate: WindowDelegate {
 
     var frame: WriteableProperty<OfType<CGRect>>!
     var size: SizeProperty!
-    var title: Property<OfType<String>>!
+    var title: Property<OfDefaultedType<String>>!
     var isMinimized: WriteableProperty<OfType<Bool>>!
     var isFullscreen: WriteableProperty<OfType<Bool>>!
 
+    var subrole: String?
+
+    var extensions = ExtensionStorage()
+
     let frame_ = StubPropertyDelegate(value: CGRect.zero)
     let position_ = StubPropertyDelegate(value: CGPoint.zero)
     let size_ = StubPropertyDelegate(value: CGSize.zero)
@@ -50,6 +88,8 @@ class StubWindowDelegate: WindowDelegate {
         size = SizeProperty(size_, notifier: notifier, frame: frame)
     }
 
+    func apply(_ changes: WindowChanges) -> Promise<Void> { return .value(()) }
+
     func equalTo(_ other: WindowDelegate) -> Bool { return self === other }
 }
 
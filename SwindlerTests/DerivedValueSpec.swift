@@ -0,0 +1,97 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class DerivedValueSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var fakeWindow: FakeWindow!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp).setTitle("first").build() }
+                    .map { fakeWindow = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        it("computes the value on creation") {
+            let titles = DerivedValue { fakeState.state.knownWindows.map { $0.title.value } }
+            expect(titles.value).to(equal(["first"]))
+            expect(titles.recomputeCount).to(equal(1))
+        }
+
+        it("does not recompute when nothing changed") {
+            let titles = DerivedValue { fakeState.state.knownWindows.map { $0.title.value } }
+            _ = titles.value
+            _ = titles.value
+            expect(titles.recomputeCount).to(equal(1))
+        }
+
+        it("recomputes when a property it read changes") {
+            let titles = DerivedValue { fakeState.state.knownWindows.map { $0.title.value } }
+            fakeWindow.title = "renamed"
+            expect(titles.value).toEventually(equal(["renamed"]))
+            expect(titles.recomputeCount).to(equal(2))
+        }
+
+        it("does not recompute when a property it did not read changes") {
+            let titles = DerivedValue { fakeState.state.knownWindows.map { $0.title.value } }
+            fakeWindow.isMinimized = true
+            expect(fakeWindow.window.isMinimized.value).toEventually(beTrue())
+            _ = titles.value
+            expect(titles.recomputeCount).to(equal(1))
+        }
+
+        it("recomputes when a window is created") { () -> Promise<Void> in
+            let count = DerivedValue { fakeState.state.knownWindows.count }
+            return FakeWindowBuilder(parent: fakeApp).build().done { _ in
+                expect(count.value).to(equal(2))
+            }
+        }
+
+        it("batches changes into a single recomputation") {
+            let titles = DerivedValue { fakeState.state.knownWindows.map { $0.title.value } }
+            var notifications = 0
+            titles.onChange { _ in notifications += 1 }
+
+            DependencyTracker.shared.changed(.collection(.windows))
+            DependencyTracker.shared.changed(.collection(.windows))
+            expect(titles.recomputeCount).toEventually(equal(2))
+            // The value is the same, so handlers aren't called.
+            expect(notifications).to(equal(0))
+        }
+
+        it("tracks other derived values") {
+            let title = DerivedValue { fakeWindow.window.title.value }
+            let length = DerivedValue { title.value.count }
+            var lengths: [Int] = []
+            length.onChange { lengths.append($0) }
+
+            fakeWindow.title = "longer title"
+            expect(lengths).toEventually(equal(["longer title".count]))
+        }
+
+        it("is up to date when read from the property's event handler") {
+            let titles = DerivedValue { fakeState.state.knownWindows.map { $0.title.value } }
+            _ = titles.value
+            var seen: [String]?
+            fakeState.state.on { (_: WindowTitleChangedEvent) in
+                seen = titles.value
+            }
+
+            fakeWindow.title = "renamed"
+            expect(seen).toEventually(equal(["renamed"]))
+        }
+
+    }
+}
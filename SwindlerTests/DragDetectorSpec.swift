@@ -0,0 +1,132 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+
+class DragDetectorSpec: QuickSpec {
+    override func spec() {
+
+        var notifier: TestNotifier!
+        var window: Window!
+        var settled: [WindowFrameChangedEvent]!
+        beforeEach {
+            notifier = TestNotifier()
+            notifier.dragDetector.settleInterval = 0.05
+            notifier.dragDetector.isMouseButtonDown = { false }
+
+            let stateDelegate = StubStateDelegate()
+            let app = Application(delegate: StubApplicationDelegate(), stateDelegate: stateDelegate)
+            window = Window(delegate: StubWindowDelegate(), application: app)
+
+            settled = []
+            notifier.onSettledFrameChange { settled.append($0) }
+        }
+
+        func frameChanged(_ from: CGRect, _ to: CGRect, external: Bool = true) {
+            notifier.notify(WindowFrameChangedEvent(
+                external: external, window: window, oldValue: from, newValue: to
+            ))
+        }
+
+        let frame0 = CGRect(x: 0, y: 0, width: 100, height: 100)
+        let frame1 = CGRect(x: 10, y: 0, width: 100, height: 100)
+        let frame2 = CGRect(x: 20, y: 0, width: 100, height: 100)
+        let frame3 = CGRect(x: 20, y: 0, width: 150, height: 100)
+
+        context("when a window moves several times in quick succession") {
+            beforeEach {
+                frameChanged(frame0, frame1)
+                frameChanged(frame1, frame2)
+            }
+
+            it("emits a WindowDragBeganEvent") {
+                if let event = notifier.expectEvent(WindowDragBeganEvent.self) {
+                    expect(event.kind).to(equal(.move))
+                    expect(event.initialFrame).to(equal(frame0))
+                }
+            }
+
+            it("emits a WindowDragEndedEvent once the window settles") {
+                if let event = notifier.expectEvent(WindowDragEndedEvent.self) {
+                    expect(event.kind).to(equal(.move))
+                    expect(event.initialFrame).to(equal(frame0))
+                    expect(event.finalFrame).to(equal(frame2))
+                }
+            }
+
+            it("delivers a single settled frame change") {
+                expect(settled.count).toEventually(equal(1))
+                expect(settled.first?.oldValue).to(equal(frame0))
+                expect(settled.first?.newValue).to(equal(frame2))
+            }
+
+            context("and is then resized") {
+                it("reports the gesture as a resize") {
+                    frameChanged(frame2, frame3)
+                    if let event = notifier.expectEvent(WindowDragEndedEvent.self) {
+                        expect(event.kind).to(equal(.resize))
+                        expect(event.finalFrame).to(equal(frame3))
+                    }
+                }
+            }
+
+            context("while the mouse button is held down") {
+                it("does not end the drag") {
+                    notifier.dragDetector.isMouseButtonDown = { true }
+                    waitUntil { done in
+                        DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) { done() }
+                    }
+                    expect(notifier.getEventOfType(WindowDragEndedEvent.self)).to(beNil())
+                }
+            }
+        }
+
+        context("when a window moves once") {
+            it("does not emit drag events") {
+                frameChanged(frame0, frame1)
+                expect(settled.count).toEventually(equal(1))
+                expect(notifier.getEventOfType(WindowDragBeganEvent.self)).to(beNil())
+                expect(notifier.getEventOfType(WindowDragEndedEvent.self)).to(beNil())
+            }
+        }
+
+        context("when the frame is changed by Swindler") {
+            it("delivers the settled frame change immediately") {
+                frameChanged(frame0, frame1, external: false)
+                expect(settled.count).to(equal(1))
+                expect(settled.first?.external).to(beFalse())
+            }
+        }
+
+        context("when nobody is listening for drags") {
+            it("does not track gestures") {
+                let notifier = TestNotifier()
+                notifier.notify(WindowFrameChangedEvent(
+                    external: true, window: window, oldValue: frame0, newValue: frame1
+                ))
+                notifier.notify(WindowFrameChangedEvent(
+                    external: true, window: window, oldValue: frame1, newValue: frame2
+                ))
+                expect(notifier.getEventsOfType(WindowFrameChangedEvent.self)).to(haveCount(2))
+                expect(notifier.getEventOfType(WindowDragBeganEvent.self)).to(beNil())
+            }
+        }
+
+        context("when a consumer listens for settled frames") {
+            it("stops calling its handlers once it is released") {
+                var consumer: EventNotifier? = EventNotifier(consumerOf: notifier, name: "test")
+                var consumerSettled = 0
+                consumer?.onSettledFrameChange { _ in consumerSettled += 1 }
+                frameChanged(frame0, frame1, external: false)
+                expect(consumerSettled).to(equal(1))
+
+                consumer = nil
+                frameChanged(frame1, frame2, external: false)
+                expect(consumerSettled).to(equal(1))
+                expect(settled.count).to(equal(2))
+            }
+        }
+
+    }
+}
@@ -27,7 +27,7 @@ class OSXDriverSpec: QuickSpec {
             let screenDel = FakeSystemScreenDelegate(screens: [FakeScreen().delegate])
             state = State(delegate: OSXStateDelegate<
                 TestUIElement, EmittingTestApplicationElement, FakeObserver, FakeApplicationObserver
-            >(appObserver: appObserver, screens: screenDel))
+            >(appObserver: appObserver, screens: screenDel, spaces: FakeSpaceObserver()))
             appElement.addWindow(windowElement)
             expect(state.knownWindows.count).toEventually(equal(1))
         }
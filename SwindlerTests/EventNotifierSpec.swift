@@ -0,0 +1,64 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+
+private struct TestEvent: EventType {
+    let external = true
+}
+
+class EventNotifierSpec: QuickSpec {
+    override func spec() {
+
+        describe("consumer notifiers") {
+            var source: EventNotifier!
+            var consumer: EventNotifier!
+            beforeEach {
+                source = EventNotifier()
+                consumer = EventNotifier(consumerOf: source, name: "test")
+            }
+
+            it("deliver events after the source's own handlers") {
+                var calls: [String] = []
+                consumer.on { (_: TestEvent) in calls.append("consumer") }
+                source.on { (_: TestEvent) in calls.append("source") }
+                source.notify(TestEvent())
+                expect(calls).to(equal(["source", "consumer"]))
+            }
+
+            it("keep their subscriptions to themselves") {
+                var sourceCalls = 0
+                var otherCalls = 0
+                let other = EventNotifier(consumerOf: source, name: "other")
+                source.on { (_: TestEvent) in sourceCalls += 1 }
+                other.on { (_: TestEvent) in otherCalls += 1 }
+                consumer.notify(TestEvent())
+                expect(sourceCalls).to(equal(0))
+                expect(otherCalls).to(equal(0))
+            }
+
+            it("stop receiving events once released") {
+                var calls = 0
+                consumer.on { (_: TestEvent) in calls += 1 }
+                consumer = nil
+                source.notify(TestEvent())
+                expect(calls).to(equal(0))
+            }
+
+            it("count as handlers of the source") {
+                expect(source.hasHandlers(for: TestEvent.self)).to(beFalse())
+                consumer.on { (_: TestEvent) in }
+                expect(source.hasHandlers(for: TestEvent.self)).to(beTrue())
+            }
+
+            it("report subscriptions to the source") {
+                var subscriptions = 0
+                source.onSubscribe(to: TestEvent.self) { subscriptions += 1 }
+                consumer.on { (_: TestEvent) in }
+                expect(subscriptions).to(equal(1))
+            }
+        }
+
+    }
+}
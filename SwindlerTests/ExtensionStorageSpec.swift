@@ -0,0 +1,78 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class ExtensionStorageSpec: QuickSpec {
+    override func spec() {
+
+        let slot = ExtensionKey<Int>()
+        let label = ExtensionKey<String>()
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var fakeWindow: FakeWindow!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp).build() }
+                    .map { fakeWindow = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        it("is empty by default") {
+            expect(fakeWindow.window[slot]).to(beNil())
+            expect(fakeApp.application[slot]).to(beNil())
+        }
+
+        it("is shared between wrappers of the same object") {
+            fakeWindow.window[slot] = 3
+            expect(fakeState.state.knownWindows.first?[slot]).to(equal(3))
+
+            fakeApp.application[label] = "browser"
+            expect(fakeState.state.runningApplications.first?[label]).to(equal("browser"))
+        }
+
+        it("keeps values for different keys separate") {
+            fakeWindow.window[slot] = 3
+            fakeWindow.window[label] = "left"
+            expect(fakeWindow.window[slot]).to(equal(3))
+            expect(fakeWindow.window[label]).to(equal("left"))
+            expect(fakeWindow.window[ExtensionKey<Int>()]).to(beNil())
+        }
+
+        it("keeps a key alive while a value is stored under it") {
+            weak var weakKey: ExtensionKey<Int>?
+            do {
+                let key = ExtensionKey<Int>()
+                weakKey = key
+                fakeWindow.window[key] = 3
+            }
+            expect(weakKey).toNot(beNil())
+
+            fakeWindow.window[weakKey!] = nil
+            expect(weakKey).to(beNil())
+        }
+
+        it("is available to WindowDestroyedEvent handlers and released afterwards") {
+            let window = fakeWindow.window
+            window[slot] = 3
+            var valueSeenByHandler: Int?
+            fakeState.state.on { (event: WindowDestroyedEvent) in
+                valueSeenByHandler = event.window[slot]
+            }
+
+            fakeWindow.element.destroy()
+            expect(valueSeenByHandler).toEventually(equal(3))
+            expect(window[slot]).to(beNil())
+        }
+
+    }
+}
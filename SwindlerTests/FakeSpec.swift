@@ -152,6 +152,24 @@ class FakeSpec: QuickSpec {
                         expect(events.first!.window).to(equal(win.window))
                     }
             }
+
+            it("batches windows created together into one WindowsCreatedEvent") {
+                var events: [WindowsCreatedEvent] = []
+                fakeState.state.on { (event: WindowsCreatedEvent) in
+                    events.append(event)
+                }
+                var created: [FakeWindow] = []
+                waitUntil { done in
+                    when(fulfilled: (0..<3).map { _ in FakeWindowBuilder(parent: fakeApp).build() })
+                        .done { created = $0; done() }
+                        .cauterize()
+                }
+
+                expect(events).toEventually(haveCount(1))
+                expect(events.first?.application).to(equal(fakeApp.application))
+                // Newer windows are in front.
+                expect(events.first?.windows).to(equal(created.reversed().map { $0.window }))
+            }
         }
 
         describe("FakeState") {
@@ -189,6 +207,54 @@ class FakeSpec: QuickSpec {
                 }
             }
 
+            context("with bundle identifiers") {
+                var fakeState: FakeState!
+                var browser: FakeApplication!
+                var editor: FakeApplication!
+                beforeEach {
+                    waitUntil { done in
+                        FakeState.initialize()
+                            .map { fakeState = $0 }
+                            .then {
+                                FakeApplicationBuilder(parent: fakeState)
+                                    .setBundleId("com.example.Browser")
+                                    .setLocalizedName("Browser")
+                                    .build()
+                            }
+                            .map { browser = $0 }
+                            .then {
+                                FakeApplicationBuilder(parent: fakeState)
+                                    .setBundleId("com.example.Editor")
+                                    .build()
+                            }
+                            .map { editor = $0 }
+                            .done { done() }
+                            .cauterize()
+                    }
+                }
+
+                it("exposes application metadata") {
+                    expect(browser.application.bundleIdentifier).to(equal("com.example.Browser"))
+                    expect(browser.application.localizedName).to(equal("Browser"))
+                    expect(browser.application.activationPolicy).to(equal(.regular))
+                }
+
+                it("indexes applications by bundle identifier") {
+                    expect(fakeState.state.applications(bundleID: "com.example.Editor"))
+                        .to(equal([editor.application]))
+                    expect(fakeState.state.applications(bundleID: "com.example.Other"))
+                        .to(beEmpty())
+                }
+
+                it("removes terminated applications from the index") {
+                    fakeState.appObserver.terminate(editor.processId)
+                    expect(fakeState.state.applications(bundleID: "com.example.Editor"))
+                        .to(beEmpty())
+                    expect(fakeState.state.applications(bundleID: "com.example.Browser"))
+                        .to(equal([browser.application]))
+                }
+            }
+
             context("") {
                 var fakeState: FakeState!
                 var fakeApp: FakeApplication!
@@ -0,0 +1,99 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class FocusTrackerSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp1: FakeApplication!
+        var fakeApp2: FakeApplication!
+        var fakeWindow1: FakeWindow!
+        var fakeWindow2: FakeWindow!
+        var events: [FocusChangedEvent] = []
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp1 = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp1).build() }
+                    .map { fakeWindow1 = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp2 = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp2).build() }
+                    .map { fakeWindow2 = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+            events = []
+            fakeState.state.on { (event: FocusChangedEvent) in events.append(event) }
+        }
+
+        func waitForSettle() {
+            waitUntil { done in
+                DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) { done() }
+            }
+        }
+
+        func focus(_ app: FakeApplication, _ window: FakeWindow) {
+            fakeState.frontmostApplication = app
+            app.mainWindow = window
+        }
+
+        it("emits one event per switch") {
+            focus(fakeApp1, fakeWindow1)
+            expect(events).toEventually(haveCount(1))
+            expect(events.last?.newApplication).to(equal(fakeApp1.application))
+            expect(events.last?.newWindow).to(equal(fakeWindow1.window))
+
+            focus(fakeApp2, fakeWindow2)
+            expect(events).toEventually(haveCount(2))
+            waitForSettle()
+            expect(events).to(haveCount(2))
+
+            let event = events.last!
+            expect(event.oldApplication).to(equal(fakeApp1.application))
+            expect(event.oldWindow).to(equal(fakeWindow1.window))
+            expect(event.newApplication).to(equal(fakeApp2.application))
+            expect(event.newWindow).to(equal(fakeWindow2.window))
+            expect(event.external).to(beTrue())
+            expect(event.latency).to(beGreaterThanOrEqualTo(0))
+        }
+
+        it("follows the focused window within an application") {
+            focus(fakeApp1, fakeWindow1)
+            expect(events).toEventually(haveCount(1))
+            var panel: FakeWindow!
+            waitUntil { done in
+                FakeWindowBuilder(parent: fakeApp1).build().done { panel = $0; done() }.cauterize()
+            }
+            fakeApp1.focusedWindow = panel
+            expect(events).toEventually(haveCount(2))
+            expect(events.last?.oldWindow).to(equal(fakeWindow1.window))
+            expect(events.last?.newWindow).to(equal(panel.window))
+            expect(events.last?.newApplication).to(equal(fakeApp1.application))
+        }
+
+        it("doesn't emit when focus ends up where it started") {
+            focus(fakeApp1, fakeWindow1)
+            expect(events).toEventually(haveCount(1))
+            fakeState.frontmostApplication = fakeApp2
+            fakeState.frontmostApplication = fakeApp1
+            waitForSettle()
+            expect(events).to(haveCount(1))
+        }
+
+        it("records transition latency") {
+            let before = fakeState.state.metrics.focusTransitionLatencies.count
+            focus(fakeApp1, fakeWindow1)
+            expect(events).toEventually(haveCount(1))
+            expect(fakeState.state.metrics.focusTransitionLatencies.count)
+                .to(equal(before + 1))
+        }
+
+    }
+}
@@ -0,0 +1,100 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class HealthSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var fakeWindow: FakeWindow!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then {
+                        FakeApplicationBuilder(parent: fakeState)
+                            .setBundleId("com.example.health")
+                            .build()
+                    }
+                    .map { fakeApp = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp).build() }
+                    .map { fakeWindow = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        func appHealth() -> ApplicationHealth? {
+            return fakeState.state.health().applications.first {
+                $0.processIdentifier == fakeApp.processId
+            }
+        }
+
+        it("reports each running application") {
+            let health = appHealth()
+            expect(health?.bundleIdentifier).to(equal("com.example.health"))
+            expect(health?.inFlightRequests).to(equal(0))
+            expect(health?.queuedRequests).to(equal(0))
+            expect(health?.pendingRefreshes).to(equal(0))
+            expect(health?.deferredWindowHandlers).to(equal(0))
+            expect(health?.lastError).to(beNil())
+        }
+
+        it("records when the application last responded") {
+            let before = appHealth()?.lastResponseDate
+            expect(before).toNot(beNil())
+
+            waitUntil { done in
+                fakeWindow.window.title.refresh().done { _ in done() }.cauterize()
+            }
+            expect(appHealth()?.lastResponseDate).to(beGreaterThanOrEqualTo(before))
+        }
+
+        it("counts refreshes that haven't run yet") {
+            let queue = DispatchQueue(label: "HealthSpec")
+            queue.suspend()
+            let title = fakeWindow.window.title
+            title.backgroundQueue = queue
+            title.refresh().cauterize()
+
+            let health = appHealth()
+            expect(health?.queuedRequests).to(equal(1))
+            expect(health?.pendingRefreshes).to(equal(1))
+            let threadPool = fakeState.state.health().threadPool
+            expect(threadPool.queuedRequests).to(beGreaterThanOrEqualTo(1))
+
+            queue.resume()
+            expect(appHealth()?.pendingRefreshes).toEventually(equal(0))
+            expect(appHealth()?.queuedRequests).to(equal(0))
+        }
+
+        it("records the last error") {
+            fakeWindow.element.throwInvalid = true
+            waitUntil { done in
+                fakeWindow.window.title.refresh().ensure { done() }.cauterize()
+            }
+            let health = appHealth()
+            expect(health?.lastError).toNot(beNil())
+            expect(health?.lastErrorDate).toNot(beNil())
+            expect(health?.pendingRefreshes).to(equal(0))
+        }
+
+        it("forgets applications that terminate") {
+            fakeState.appObserver.terminate(fakeApp.processId)
+            expect(appHealth()).toEventually(beNil())
+        }
+
+        it("is cheap to collect") {
+            let start = Date()
+            for _ in 0..<1000 {
+                _ = fakeState.state.health()
+            }
+            expect(Date().timeIntervalSince(start)).to(beLessThan(1))
+        }
+
+    }
+}
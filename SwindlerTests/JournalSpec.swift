@@ -0,0 +1,160 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class JournalSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var fakeWindow: FakeWindow!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then {
+                        FakeApplicationBuilder(parent: fakeState)
+                            .setBundleId("com.example.journal")
+                            .build()
+                    }
+                    .map { fakeApp = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp).setTitle("first").build() }
+                    .map { fakeWindow = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        var journal: EventJournal!
+        var start: Date!
+        var now: Date!
+        func advance(_ seconds: TimeInterval) {
+            now = now.addingTimeInterval(seconds)
+        }
+        func startJournal(memoryBudget: Int = 4 << 20, maxChangesPerCheckpoint: Int = 2000) {
+            journal = EventJournal(state: fakeState.state,
+                                   memoryBudget: memoryBudget,
+                                   maxChangesPerCheckpoint: maxChangesPerCheckpoint)
+            start = Date()
+            now = start
+            journal.clock = { now }
+        }
+
+        func setFrame(_ frame: CGRect) {
+            waitUntil { done in
+                fakeWindow.window.frame.set(frame).done { _ in done() }.cauterize()
+            }
+        }
+
+        it("starts from the current state") {
+            startJournal()
+            let snapshot = journal.snapshot(at: start)
+            let windowID = journal.id(of: fakeWindow.window)
+            expect(windowID).toNot(beNil())
+            expect(snapshot?.windows[windowID!]?.title).to(equal("first"))
+            expect(snapshot?.windows[windowID!]?.frame).to(equal(fakeWindow.window.frame.value))
+            expect(snapshot?.applications[fakeApp.processId]?.bundleIdentifier)
+                .to(equal("com.example.journal"))
+            expect(snapshot?.screens).to(equal(fakeState.state.screens.map { $0.frame }))
+        }
+
+        it("reconstructs the model at earlier times") {
+            startJournal()
+            let original = fakeWindow.window.frame.value
+            let first = CGRect(x: 100, y: 100, width: 400, height: 300)
+            let second = CGRect(x: 500, y: 200, width: 400, height: 300)
+
+            advance(10)
+            setFrame(first)
+            advance(10)
+            setFrame(second)
+
+            let id = journal.id(of: fakeWindow.window)!
+            func frame(after seconds: TimeInterval) -> CGRect? {
+                return journal.snapshot(at: start + seconds)?.windows[id]?.frame
+            }
+            expect(frame(after: 5)).to(equal(original))
+            expect(frame(after: 15)).to(equal(first))
+            expect(frame(after: 25)).to(equal(second))
+            expect(journal.snapshot(at: start - 1)).to(beNil())
+        }
+
+        it("records windows that are created and destroyed") {
+            startJournal()
+            advance(10)
+            var created: FakeWindow!
+            waitUntil { done in
+                FakeWindowBuilder(parent: fakeApp)
+                    .setTitle("second")
+                    .build()
+                    .done { created = $0; done() }
+                    .cauterize()
+            }
+            expect(journal.id(of: created.window)).toEventuallyNot(beNil())
+            let id = journal.id(of: created.window)!
+            advance(10)
+            let window = created.window
+            created.element.destroy()
+            expect(window.isValid).toEventually(beFalse())
+
+            expect(journal.snapshot(at: start + 5)?.windows[id]).to(beNil())
+            expect(journal.snapshot(at: start + 15)?.windows[id]?.title).to(equal("second"))
+            expect(journal.snapshot(at: start + 25)?.windows[id]).to(beNil())
+        }
+
+        it("stays within its memory budget") {
+            let budget = 16 << 10
+            startJournal(memoryBudget: budget, maxChangesPerCheckpoint: 50)
+            let window = fakeWindow.window
+            let notifier = fakeState.state.delegate.notifier
+            for i in 0..<2000 {
+                advance(1)
+                let frame = CGRect(x: i, y: 0, width: 100, height: 100)
+                notifier.notify(WindowFrameChangedEvent(
+                    external: true, window: window, oldValue: frame, newValue: frame))
+                expect(journal.memoryUsage).to(beLessThanOrEqualTo(budget))
+            }
+
+            expect(journal.oldestDate).to(beGreaterThan(start + 1000))
+            let latest = journal.snapshot(at: now)
+            expect(latest?.windows[journal.id(of: window)!]?.frame.minX).to(equal(1999))
+        }
+
+        describe("spilling to disk") {
+            var url: URL!
+            beforeEach {
+                url = FileManager.default.temporaryDirectory
+                    .appendingPathComponent("JournalSpec-\(UUID().uuidString).journal")
+            }
+            afterEach {
+                try? FileManager.default.removeItem(at: url)
+            }
+
+            it("writes a file that reconstructs the same snapshots") {
+                startJournal()
+                try! journal.spill(to: url)
+                advance(10)
+                setFrame(CGRect(x: 100, y: 100, width: 400, height: 300))
+                advance(10)
+                fakeState.state.delegate.notifier.notify(WindowTitleChangedEvent(
+                    external: true, window: fakeWindow.window, oldValue: "first", newValue: "é"))
+                journal.waitForSpill()
+
+                for seconds in [5.0, 15, 25] {
+                    let fromFile = try! EventJournal.snapshot(fromFile: url, at: start + seconds)
+                    expect(fromFile).to(equal(journal.snapshot(at: start + seconds)))
+                }
+            }
+
+            it("rejects files that aren't journals") {
+                try! Data("not a journal".utf8).write(to: url)
+                expect { try EventJournal.snapshot(fromFile: url, at: Date()) }
+                    .to(throwError(JournalError.invalidFormat))
+            }
+        }
+
+    }
+}
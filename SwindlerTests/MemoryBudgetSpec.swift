@@ -0,0 +1,131 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+private final class TestCache: EvictableCache {
+    let cacheName: String
+    var estimatedCost: Int
+    var evictions: [Int] = []
+
+    init(_ name: String, cost: Int) {
+        cacheName = name
+        estimatedCost = cost
+    }
+
+    func evict(bytes: Int) -> Int {
+        evictions.append(bytes)
+        let freed = min(bytes, estimatedCost)
+        estimatedCost -= freed
+        return freed
+    }
+}
+
+class MemoryBudgetSpec: QuickSpec {
+    override func spec() {
+
+        describe("MemoryBudget") {
+            var budget: MemoryBudget!
+            var diagnostics: TestCache!
+            var large: TestCache!
+            var important: TestCache!
+            beforeEach {
+                budget = MemoryBudget()
+                diagnostics = TestCache("diagnostics", cost: 100)
+                large = TestCache("large", cost: 1000)
+                important = TestCache("important", cost: 500)
+                budget.register(important, priority: .last)
+                budget.register(large, priority: .normal)
+                budget.register(diagnostics, priority: .first)
+            }
+
+            it("reports the cost of each cache") {
+                expect(budget.totalCost).to(equal(1600))
+                expect(budget.costs()["large"]).to(equal(1000))
+            }
+
+            it("sheds caches in priority order") {
+                expect(budget.shed(toCost: 1000)).to(equal(600))
+                expect(diagnostics.estimatedCost).to(equal(0))
+                expect(large.estimatedCost).to(equal(500))
+                expect(important.estimatedCost).to(equal(500))
+                expect(important.evictions).to(beEmpty())
+                expect(budget.evictedBytes).to(equal(600))
+            }
+
+            it("does nothing when within the target") {
+                expect(budget.shed(toCost: 2000)).to(equal(0))
+                expect(large.evictions).to(beEmpty())
+            }
+
+            it("sheds once a cache grows over the limit") {
+                budget.limit = 2000
+                large.estimatedCost = 2000
+                budget.cacheDidGrow()
+                expect(budget.totalCost).toEventually(equal(2000))
+                expect(diagnostics.estimatedCost).to(equal(0))
+            }
+
+            it("sheds to half the limit on a memory pressure warning") {
+                budget.limit = 1000
+                budget.handleMemoryPressure(.warning)
+                expect(budget.totalCost).to(equal(500))
+            }
+
+            it("sheds everything on critical memory pressure") {
+                budget.handleMemoryPressure(.critical)
+                expect(budget.totalCost).to(equal(0))
+            }
+
+            it("forgets caches that are unregistered or deallocated") {
+                budget.unregister(large)
+                diagnostics = nil
+                expect(budget.totalCost).to(equal(500))
+            }
+        }
+
+        describe("Swindler caches") {
+            var fakeState: FakeState!
+            var fakeApp: FakeApplication!
+            beforeEach {
+                waitUntil { done in
+                    FakeState.initialize()
+                        .map { fakeState = $0 }
+                        .then { FakeApplicationBuilder(parent: fakeState).build() }
+                        .map { fakeApp = $0 }
+                        .then { FakeWindowBuilder(parent: fakeApp).build() }
+                        .done { _ in done() }
+                        .cauterize()
+                }
+            }
+
+            it("include the event journal") {
+                let journal = EventJournal(state: fakeState.state)
+                let window = fakeState.state.knownWindows.first!
+                let notifier = fakeState.state.delegate.notifier
+                for i in 0..<100 {
+                    let frame = CGRect(x: i, y: 0, width: 100, height: 100)
+                    notifier.notify(WindowFrameChangedEvent(
+                        external: true, window: window, oldValue: frame, newValue: frame))
+                }
+                let before = journal.memoryUsage
+                expect(fakeState.state.memoryBudget.costs()["event journal"])
+                    .to(beGreaterThanOrEqualTo(before))
+
+                expect(journal.evict(bytes: before)).to(beGreaterThan(0))
+                expect(journal.memoryUsage).to(beLessThan(before))
+                expect(journal.snapshot(at: Date())).toNot(beNil())
+            }
+
+            it("release the windows of terminated applications") {
+                let application = fakeApp.application
+                expect(application.knownWindows).to(haveCount(1))
+                fakeState.appObserver.terminate(fakeApp.processId)
+                expect(application.knownWindows).toEventually(beEmpty())
+            }
+        }
+
+    }
+}
@@ -0,0 +1,218 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+
+private struct SlowEvent: EventType {
+    let external = true
+}
+
+private struct NestedEvent: EventType {
+    let external = true
+}
+
+class MetricsSpec: QuickSpec {
+    override func spec() {
+
+        describe("Histogram") {
+            it("puts values in the right buckets") {
+                var histogram = Histogram(bucketBounds: [10, 100])
+                histogram.record(5)
+                histogram.record(10)
+                histogram.record(50)
+                histogram.record(500)
+                expect(histogram.bucketCounts).to(equal([2, 1, 1]))
+                expect(histogram.count).to(equal(4))
+                expect(histogram.max).to(equal(500))
+                expect(histogram.mean).to(equal(141.25))
+            }
+        }
+
+        describe("stall watchdog") {
+            let metrics = Metrics.shared
+            beforeEach {
+                metrics.reset()
+                metrics.startStallWatchdog(threshold: 0.05)
+            }
+            afterEach {
+                metrics.stopStallWatchdog()
+            }
+
+            it("reports the handler that blocked the main thread") {
+                let notifier = EventNotifier()
+                notifier.on { (_: SlowEvent) in }
+                notifier.on { (_: SlowEvent) in Thread.sleep(forTimeInterval: 0.3) }
+                notifier.notify(SlowEvent())
+
+                expect(metrics.recentStalls).toEventually(haveCount(1))
+                let stall = metrics.recentStalls.first
+                expect(stall?.event).to(contain("SlowEvent"))
+                expect(stall?.handlerIndex).to(equal(1))
+                expect(stall?.handlerLabel).to(beNil())
+                expect(stall?.duration).to(beGreaterThanOrEqualTo(0.25))
+                expect(metrics.stallDurations.count).to(equal(1))
+            }
+
+            it("reports the label of the handler") {
+                let notifier = EventNotifier()
+                notifier.on(label: "sleepy") { (_: SlowEvent) in
+                    Thread.sleep(forTimeInterval: 0.3)
+                }
+                notifier.notify(SlowEvent())
+
+                expect(metrics.recentStalls).toEventually(haveCount(1))
+                expect(metrics.recentStalls.first?.handlerLabel).to(equal("sleepy"))
+            }
+
+            it("reports the outer handler after a nested event is delivered") {
+                let notifier = EventNotifier()
+                notifier.on { (_: NestedEvent) in }
+                notifier.on(label: "outer") { (_: SlowEvent) in
+                    notifier.notify(NestedEvent())
+                    Thread.sleep(forTimeInterval: 0.3)
+                }
+                notifier.notify(SlowEvent())
+
+                expect(metrics.recentStalls).toEventually(haveCount(1))
+                expect(metrics.recentStalls.first?.event).to(contain("SlowEvent"))
+                expect(metrics.recentStalls.first?.handlerLabel).to(equal("outer"))
+            }
+
+            it("reports background threads waiting on the main thread") {
+                let waiting = DispatchSemaphore(value: 0)
+                DispatchQueue.global().async {
+                    waiting.signal()
+                    syncOnMainThread("test hop") {}
+                }
+                waiting.wait()
+                Thread.sleep(forTimeInterval: 0.3)
+
+                expect(metrics.recentStalls).toEventually(haveCount(1))
+                expect(metrics.recentStalls.first?.event).to(beNil())
+                expect(metrics.recentStalls.first?.pendingSyncHops).to(equal(["test hop"]))
+            }
+
+            it("does not report when the main thread is responsive") {
+                waitUntil { done in
+                    DispatchQueue.main.asyncAfter(deadline: .now() + 0.3) { done() }
+                }
+                expect(metrics.recentStalls).to(beEmpty())
+            }
+        }
+
+
+        describe("handler profiling") {
+            let metrics = Metrics.shared
+            var notifier: EventNotifier!
+            beforeEach {
+                metrics.reset()
+                metrics.isHandlerProfilingEnabled = true
+                notifier = EventNotifier()
+            }
+            afterEach {
+                metrics.isHandlerProfilingEnabled = false
+                metrics.handlerBudget = 0.016
+                metrics.onHandlerOverBudget = nil
+            }
+
+            func report(labeled label: String) -> HandlerReport? {
+                return metrics.slowestHandlers(limit: .max).first { $0.label == label }
+            }
+
+            func spin(_ duration: TimeInterval) {
+                let start = threadCPUTime()
+                while threadCPUTime() - start < duration {}
+            }
+
+            it("lists the slowest handlers first") {
+                notifier.on(label: "fast") { (_: SlowEvent) in }
+                notifier.on(label: "slow") { (_: SlowEvent) in spin(0.02) }
+                notifier.notify(SlowEvent())
+                notifier.notify(SlowEvent())
+
+                let reports = metrics.slowestHandlers(limit: .max)
+                    .filter { $0.label == "slow" || $0.label == "fast" }
+                expect(reports.map { $0.label }).to(equal(["slow", "fast"]))
+                expect(reports.first?.calls).to(equal(2))
+                expect(reports.first?.eventType).to(contain("SlowEvent"))
+                expect(reports.first?.totalCPUTime).to(beGreaterThanOrEqualTo(0.04))
+                expect(reports.first?.meanCPUTime).to(beGreaterThanOrEqualTo(0.02))
+            }
+
+            it("does not count time spent sleeping") {
+                notifier.on(label: "sleepy") { (_: SlowEvent) in
+                    Thread.sleep(forTimeInterval: 0.05)
+                }
+                notifier.notify(SlowEvent())
+                let sleepy = report(labeled: "sleepy")
+                expect(sleepy?.totalCPUTime).to(beLessThan(0.04))
+            }
+
+            it("sums time per event type") {
+                notifier.on { (_: SlowEvent) in spin(0.01) }
+                notifier.notify(SlowEvent())
+                let byEvent = metrics.handlerCPUTimeByEvent()
+                expect(byEvent[SlowEvent.typeName]).to(beGreaterThanOrEqualTo(0.01))
+            }
+
+            it("sums time per consumer") {
+                let consumer = EventNotifier(consumerOf: notifier, name: "module")
+                consumer.on(label: "consumed") { (_: SlowEvent) in spin(0.01) }
+                notifier.on { (_: SlowEvent) in spin(0.01) }
+                withExtendedLifetime(consumer) {
+                    notifier.notify(SlowEvent())
+
+                    expect(report(labeled: "consumed")?.consumer).to(equal("module"))
+                    let byConsumer = metrics.handlerCPUTimeByConsumer()
+                    expect(byConsumer.keys.sorted()).to(equal(["module"]))
+                    expect(byConsumer["module"]).to(beGreaterThanOrEqualTo(0.01))
+                }
+            }
+
+            it("reports handlers that go over the default budget") {
+                var overruns: [String?] = []
+                metrics.handlerBudget = 0.005
+                metrics.onHandlerOverBudget = { report, _ in overruns.append(report.label) }
+                notifier.on(label: "fast") { (_: SlowEvent) in }
+                notifier.on(label: "slow") { (_: SlowEvent) in spin(0.01) }
+                notifier.notify(SlowEvent())
+
+                expect(overruns).to(equal(["slow"]))
+                expect(report(labeled: "slow")?.overBudgetCalls).to(equal(1))
+            }
+
+            it("prefers the budget given when subscribing") {
+                var overruns = 0
+                metrics.handlerBudget = nil
+                metrics.onHandlerOverBudget = { _, _ in overruns += 1 }
+                notifier.on(label: "tight", budget: 0.001) { (_: SlowEvent) in spin(0.005) }
+                notifier.on(label: "unbudgeted") { (_: SlowEvent) in spin(0.005) }
+                notifier.notify(SlowEvent())
+
+                expect(overruns).to(equal(1))
+            }
+
+            it("does not count the handlers of nested events") {
+                notifier.on(label: "outer") { (_: SlowEvent) in
+                    spin(0.01)
+                    notifier.notify(NestedEvent())
+                }
+                notifier.on(label: "inner") { (_: NestedEvent) in spin(0.03) }
+                notifier.notify(SlowEvent())
+
+                expect(report(labeled: "inner")?.totalCPUTime).to(beGreaterThanOrEqualTo(0.03))
+                expect(report(labeled: "outer")?.totalCPUTime).to(beGreaterThanOrEqualTo(0.01))
+                expect(report(labeled: "outer")?.totalCPUTime).to(beLessThan(0.03))
+            }
+
+            it("measures nothing when disabled") {
+                metrics.isHandlerProfilingEnabled = false
+                notifier.on(label: "ignored") { (_: SlowEvent) in }
+                notifier.notify(SlowEvent())
+                expect(report(labeled: "ignored")).to(beNil())
+            }
+        }
+
+    }
+}
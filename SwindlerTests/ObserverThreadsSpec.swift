@@ -0,0 +1,119 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import AXSwift
+import PromiseKit
+
+class ObserverThreadsSpec: QuickSpec {
+    override func spec() {
+
+        describe("ObserverThread") {
+            var thread: ObserverThread!
+            beforeEach {
+                thread = ObserverThread(name: "test")
+                thread.start()
+            }
+            afterEach {
+                thread.stop()
+            }
+
+            it("runs blocks on the thread") {
+                let ranOnThread = try! thread.sync { Thread.current == thread }
+                expect(ranOnThread).to(beTrue())
+            }
+
+            it("passes errors back to the caller") {
+                struct TestError: Error {}
+                expect(try thread.sync { () -> Int in throw TestError() }).to(throwError())
+            }
+        }
+
+        describe("NotificationBatcher") {
+            it("delivers notifications on the main thread in order, dropping repeats") {
+                var received: [String] = []
+                var onMainThread = true
+                let batcher = NotificationBatcher<Int, Int> { _, element, notification in
+                    onMainThread = onMainThread && Thread.current.isMainThread
+                    received.append("\(element) \(notification.rawValue)")
+                }
+                DispatchQueue.global().sync {
+                    batcher.enqueue(0, 1, .titleChanged)
+                    batcher.enqueue(0, 1, .titleChanged)
+                    batcher.enqueue(0, 2, .moved)
+                    batcher.enqueue(0, 1, .titleChanged)
+                }
+
+                expect(received).toEventually(equal([
+                    "1 AXTitleChanged", "2 AXMoved", "1 AXTitleChanged"
+                ]))
+                expect(onMainThread).to(beTrue())
+                expect(batcher.droppedRepeats).to(equal(1))
+            }
+        }
+
+        context("with observer threads") {
+            typealias AppDelegate =
+                OSXApplicationDelegate<TestUIElement, EmittingTestApplicationElement, FakeObserver>
+
+            var fakeState: FakeState!
+            var fakeApp: FakeApplication!
+            var fakeWindow: FakeWindow!
+            beforeEach {
+                // Quick also has a Configuration type.
+                var configuration = Swindler.Configuration()
+                configuration.observerThreads = 2
+                waitUntil { done in
+                    FakeState.initialize(configuration: configuration)
+                        .map { fakeState = $0 }
+                        .then { FakeApplicationBuilder(parent: fakeState).build() }
+                        .map { fakeApp = $0 }
+                        .then { FakeWindowBuilder(parent: fakeApp).build() }
+                        .map { fakeWindow = $0 }
+                        .done { done() }
+                        .cauterize()
+                }
+            }
+
+            it("receives notifications off the main thread") {
+                let appDelegate = fakeApp.application.delegate as! AppDelegate
+                expect(appDelegate.observer.runLoop === CFRunLoopGetMain()).to(beFalse())
+            }
+
+            it("delivers events on the main thread, in order") {
+                var titles: [String] = []
+                var onMainThread = true
+                fakeState.state.on { (event: WindowTitleChangedEvent) in
+                    onMainThread = onMainThread && Thread.current.isMainThread
+                    titles.append(event.newValue)
+                }
+
+                fakeWindow.title = "one"
+                fakeWindow.title = "two"
+                fakeWindow.title = "three"
+                expect(fakeWindow.window.title.value).toEventually(equal("three"))
+                expect(titles.last).to(equal("three"))
+                expect(["one", "two", "three"].filter(titles.contains)).to(equal(titles))
+                expect(onMainThread).to(beTrue())
+            }
+
+            it("releases the observer as soon as the application terminates") {
+                let appDelegate = fakeApp.application.delegate as! AppDelegate
+                fakeWindow.title = "pending"
+                fakeState.appObserver.terminate(fakeApp.processId)
+                expect(appDelegate.observer == nil).toEventually(beTrue())
+            }
+
+            it("tracks windows the application creates") {
+                waitUntil { done in
+                    FakeWindowBuilder(parent: fakeApp).build()
+                        .done { _ in done() }
+                        .cauterize()
+                }
+                expect(fakeState.state.knownWindows).toEventually(haveCount(2))
+            }
+        }
+
+    }
+}
@@ -0,0 +1,147 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class PollingSpec: QuickSpec {
+    override func spec() {
+
+        describe("IPCBudget") {
+            var budget: IPCBudget!
+            var now: Date!
+            beforeEach {
+                budget = IPCBudget(requestsPerSecond: 10, burst: 5)
+                now = Date()
+                budget.clock = { now }
+            }
+
+            it("allows bursts up to its size") {
+                expect(budget.tryConsume(5)).to(beTrue())
+                expect(budget.tryConsume(1)).to(beFalse())
+                expect(budget.deniedRequests).to(equal(1))
+            }
+
+            it("refills over time") {
+                expect(budget.tryConsume(5)).to(beTrue())
+                now = now.addingTimeInterval(0.2)
+                expect(budget.tryConsume(2)).to(beTrue())
+                expect(budget.tryConsume(1)).to(beFalse())
+            }
+
+            it("never holds more than its burst size") {
+                now = now.addingTimeInterval(60)
+                expect(budget.available).to(equal(5))
+            }
+        }
+
+        describe("PollingSupervisor") {
+            var fakeState: FakeState!
+            var fakeApp: FakeApplication!
+            var fakeWindow: FakeWindow!
+            var polling: PollingSupervisor!
+            beforeEach {
+                waitUntil { done in
+                    FakeState.initialize()
+                        .map { fakeState = $0 }
+                        .then { FakeApplicationBuilder(parent: fakeState).build() }
+                        .map { fakeApp = $0 }
+                        .then { FakeWindowBuilder(parent: fakeApp).setTitle("before").build() }
+                        .map { fakeWindow = $0 }
+                        .done { done() }
+                        .cauterize()
+                }
+                polling = fakeState.state.polling
+                polling.minimumInterval = 0.05
+            }
+
+            // Changes the title without sending a notification.
+            func changeTitleSilently(_ title: String) {
+                fakeWindow.element.attrs[.title] = title
+            }
+
+            it("is disabled by default") {
+                expect(polling.isEnabled).to(beFalse())
+            }
+
+            context("when enabled") {
+                beforeEach {
+                    polling.isEnabled = true
+                }
+
+                it("emits events for changes it finds") {
+                    var events: [WindowTitleChangedEvent] = []
+                    fakeState.state.on { (event: WindowTitleChangedEvent) in events.append(event) }
+
+                    polling.markUnreliable(fakeApp.processId)
+                    changeTitleSilently("after")
+                    expect(fakeWindow.window.title.value).toEventually(equal("after"))
+                    expect(events.first?.newValue).to(equal("after"))
+                    expect(events.first?.external).to(beTrue())
+                }
+
+                it("polls applications that miss notifications") {
+                    polling.auditInterval = 0.05
+                    expect(polling.unreliableApplications).to(beEmpty())
+
+                    changeTitleSilently("first")
+                    expect(fakeWindow.window.title.value).toEventually(equal("first"))
+                    changeTitleSilently("second")
+                    expect(fakeWindow.window.title.value).toEventually(equal("second"))
+                    expect(polling.unreliableApplications).toEventually(equal([fakeApp.processId]))
+                }
+
+                it("doesn't count changes it was notified of") {
+                    polling.auditInterval = 0.05
+                    for title in ["first", "second", "third"] {
+                        waitUntil { done in
+                            fakeWindow.window.title.set(title).done { _ in done() }.cauterize()
+                        }
+                    }
+                    waitUntil { done in
+                        DispatchQueue.main.asyncAfter(deadline: .now() + 0.3) { done() }
+                    }
+                    expect(polling.unreliableApplications).to(beEmpty())
+                }
+
+                it("postpones polls over the IPC budget") {
+                    polling.ipcBudget.burst = 0
+                    polling.ipcBudget.requestsPerSecond = 0
+                    polling.markUnreliable(fakeApp.processId)
+                    changeTitleSilently("after")
+                    expect(polling.ipcBudget.deniedRequests).toEventually(beGreaterThan(0))
+                    expect(fakeWindow.window.title.value).to(equal("before"))
+                }
+            }
+
+            it("prefetches windows when an application becomes frontmost") {
+                changeTitleSilently("after")
+                fakeState.frontmostApplication = fakeApp
+                expect(fakeWindow.window.title.value).toEventually(equal("after"))
+                expect(polling.prefetchedWindowChanges).toEventually(equal(1))
+                expect(polling.unreliableApplications).to(beEmpty())
+            }
+
+            it("prefetches even when over the IPC budget") {
+                polling.ipcBudget.burst = 0
+                polling.ipcBudget.requestsPerSecond = 0
+                changeTitleSilently("after")
+                fakeState.frontmostApplication = fakeApp
+                expect(fakeWindow.window.title.value).toEventually(equal("after"))
+                expect(polling.ipcBudget.available).to(beLessThan(0))
+            }
+
+            it("does nothing when disabled") {
+                polling.isEnabled = false
+                polling.markUnreliable(fakeApp.processId)
+                changeTitleSilently("after")
+                waitUntil { done in
+                    DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) { done() }
+                }
+                expect(fakeWindow.window.title.value).to(equal("before"))
+            }
+        }
+
+    }
+}
@@ -316,6 +316,34 @@ class PropertySpec: QuickSpec {
             }
         }
 
+        describe("update(fromPolled:ifUnchangedSince:)") {
+            let thirdFrame = CGRect(x: 1, y: 2, width: 3, height: 4)
+
+            it("stores a changed value and emits an external ChangedEvent") {
+                let sequence = property.changeSequence
+                expect(property.update(fromPolled: [.frame: secondFrame],
+                                       ifUnchangedSince: sequence)).to(beTrue())
+                expect(property.value).to(equal(secondFrame))
+                expect(notifier.events.first?.external).to(beTrue())
+            }
+
+            it("drops a value read before a refresh completed") {
+                // The poll reads thirdFrame; then the app changes again and a refresh stores
+                // secondFrame before the poll result is handled.
+                let sequence = property.changeSequence
+                windowElement.attrs[.frame] = secondFrame
+                waitUntil { done in
+                    property.refresh().done { _ in done() }.cauterize()
+                }
+                expect(notifier.events).to(haveCount(1))
+
+                expect(property.update(fromPolled: [.frame: thirdFrame],
+                                       ifUnchangedSince: sequence)).to(beFalse())
+                expect(property.value).to(equal(secondFrame))
+                expect(notifier.events).to(haveCount(1))
+            }
+        }
+
         describe("set") {
 
             it("eventually updates the property value") {
@@ -535,5 +563,19 @@ class PropertySpec: QuickSpec {
             }
         }
 
+        describe("delegate box") {
+            it("dispatches to the concrete delegate") {
+                let impl = TestPropertyDelegate<CGRect>(value: firstFrame)
+                let property = WriteableProperty<OfType<CGRect>>(
+                    impl, notifier: TestPropertyNotifier())
+
+                expect(property.delegate as? TestPropertyDelegate<CGRect>).to(beIdenticalTo(impl))
+                expect(try property.delegate_.readValue()).to(equal(firstFrame))
+                try! property.delegate_.writeValue(secondFrame)
+                expect(try impl.readValue()).to(equal(secondFrame))
+                expect(property.delegate_.readValue(from: [.frame: secondFrame])).to(beNil())
+            }
+        }
+
     }
 }
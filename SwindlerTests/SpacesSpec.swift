@@ -0,0 +1,157 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class SpacesSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var fakeWindow: FakeWindow!
+        beforeEach {
+            var configuration = Swindler.Configuration()
+            configuration.spaceTracking = true
+            waitUntil { done in
+                FakeState.initialize(configuration: configuration)
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .then { FakeWindowBuilder(parent: fakeApp).build() }
+                    .map { fakeWindow = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        func build(_ builder: FakeWindowBuilder) -> FakeWindow {
+            var window: FakeWindow!
+            waitUntil { done in
+                builder.build().done { window = $0; done() }.cauterize()
+            }
+            return window
+        }
+
+        func waitForDiscovery() {
+            waitUntil { done in
+                DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) { done() }
+            }
+        }
+
+        it("places known windows on the visible space") {
+            let state = fakeState.state
+            expect(state.currentSpaces.map { $0.id }).to(equal([1]))
+            expect(state.knownSpaces).to(equal(state.currentSpaces))
+            expect(fakeWindow.window.space).to(equal(state.currentSpaces.first))
+            expect(state.currentSpace(on: state.screens[0])?.knownWindows)
+                .to(equal([fakeWindow.window]))
+        }
+
+        it("reports the windows lost and gained by a space switch") {
+            var events: [SpaceChangedEvent] = []
+            fakeState.state.on { (event: SpaceChangedEvent) in events.append(event) }
+
+            fakeState.currentSpaceIDs = [2]
+            expect(events).to(haveCount(1))
+            expect(events.last?.oldValue?.id).to(equal(1))
+            expect(events.last?.newValue.id).to(equal(2))
+            expect(events.last?.windowsLost).to(equal([fakeWindow.window]))
+            expect(events.last?.windowsGained).to(beEmpty())
+            expect(fakeWindow.window.space?.isVisible).to(beFalse())
+
+            fakeState.currentSpaceIDs = [1]
+            expect(events).to(haveCount(2))
+            expect(events.last?.windowsLost).to(beEmpty())
+            expect(events.last?.windowsGained).to(equal([fakeWindow.window]))
+            expect(fakeState.state.knownSpaces.map { $0.id }).to(equal([1, 2]))
+        }
+
+        it("keeps visibleWindows up to date") {
+            fakeState.currentSpaceIDs = [2]
+            expect(fakeState.state.visibleWindows).to(beEmpty())
+            fakeState.currentSpaceIDs = [1]
+            expect(fakeState.state.visibleWindows).to(equal([fakeWindow.window]))
+        }
+
+        it("discovers windows on spaces it hasn't seen") {
+            var events: [WindowDiscoveredEvent] = []
+            fakeState.state.on { (event: WindowDiscoveredEvent) in events.append(event) }
+            let other = build(FakeWindowBuilder(parent: fakeApp).setSpace(2))
+            expect(fakeState.state.knownWindows).to(haveCount(1))
+
+            fakeState.currentSpaceIDs = [2]
+            expect(events).toEventually(haveCount(1))
+            expect(events.first?.window).to(equal(other.window))
+            expect(fakeState.state.knownWindows).to(haveCount(2))
+            expect(other.window.space?.id).to(equal(2))
+            expect(fakeState.state.visibleWindows).to(equal([other.window]))
+        }
+
+        it("doesn't look for windows again on spaces it has seen") {
+            fakeState.currentSpaceIDs = [2]
+            waitForDiscovery()
+            fakeState.currentSpaceIDs = [1]
+            _ = build(FakeWindowBuilder(parent: fakeApp).setSpace(2))
+
+            fakeState.currentSpaceIDs = [2]
+            waitForDiscovery()
+            expect(fakeState.state.knownWindows).to(haveCount(1))
+        }
+
+        it("puts windows listed on several spaces on all spaces") {
+            let sticky = build(FakeWindowBuilder(parent: fakeApp).setOnAllSpaces())
+            expect(sticky.window.space?.id).to(equal(1))
+
+            fakeState.currentSpaceIDs = [2]
+            expect(sticky.window.space).toEventually(beNil())
+            expect(fakeState.state.visibleWindows).to(equal([sticky.window]))
+        }
+
+        it("doesn't place windows found while the spaces changed") {
+            var events: [WindowDiscoveredEvent] = []
+            fakeState.state.on { (event: WindowDiscoveredEvent) in events.append(event) }
+            let other = build(FakeWindowBuilder(parent: fakeApp).setSpace(2))
+
+            fakeState.currentSpaceIDs = [2]
+            // Let the window list be read before the user moves on to another space.
+            Thread.sleep(forTimeInterval: 0.1)
+            fakeState.currentSpaceIDs = [3]
+            expect(events).toEventually(haveCount(1))
+            waitForDiscovery()
+            expect(other.window.space).to(beNil())
+
+            // Switching back finds the window's space.
+            fakeState.currentSpaceIDs = [2]
+            expect(other.window.space?.id).toEventually(equal(2))
+        }
+
+        it("postpones discovery over the IPC budget") {
+            let budget = fakeState.state.polling.ipcBudget
+            budget.burst = 0
+            budget.requestsPerSecond = 0
+            _ = build(FakeWindowBuilder(parent: fakeApp).setSpace(2))
+
+            fakeState.currentSpaceIDs = [2]
+            waitForDiscovery()
+            expect(budget.deniedRequests).to(beGreaterThan(0))
+            expect(fakeState.state.knownWindows).to(haveCount(1))
+        }
+
+        it("doesn't track spaces unless configured to") {
+            var untracked: FakeState!
+            waitUntil { done in
+                FakeState.initialize().done { untracked = $0; done() }.cauterize()
+            }
+            var events: [SpaceChangedEvent] = []
+            untracked.state.on { (event: SpaceChangedEvent) in events.append(event) }
+
+            untracked.currentSpaceIDs = [2]
+            expect(untracked.state.knownSpaces).to(beEmpty())
+            expect(untracked.state.currentSpaces).to(beEmpty())
+            expect(events).to(beEmpty())
+        }
+
+    }
+}
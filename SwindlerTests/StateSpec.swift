@@ -12,6 +12,9 @@ class StubApplicationObserver: ApplicationObserverType {
     func onApplicationLaunched(_ handler: @escaping (pid_t) -> Void) {}
     func onApplicationTerminated(_ handler: @escaping (pid_t) -> Void) {}
     func makeApplicationFrontmost(_ pid: pid_t) throws {}
+    func metadata(forProcessID processID: pid_t) -> ApplicationMetadata {
+        return ApplicationMetadata()
+    }
 
     typealias ApplicationElement = TestApplicationElement
     var allApps: [ApplicationElement] = []
@@ -33,7 +36,7 @@ class OSXStateDelegateSpec: QuickSpec {
             let screenDel = FakeSystemScreenDelegate(screens: [FakeScreen().delegate])
             let stateDel = OSXStateDelegate<
                 TestUIElement, AppObserver.ApplicationElement, TestObserver, AppObserver
-            >(appObserver: appObserver, screens: screenDel)
+            >(appObserver: appObserver, screens: screenDel, spaces: FakeSpaceObserver())
             waitUntil { done in
                 stateDel.frontmostApplication.initialized.done { done() }.cauterize()
             }
@@ -70,7 +73,8 @@ class OSXStateDelegateSpec: QuickSpec {
                 observer.allApps = apps
                 return OSXStateDelegate(
                     appObserver: observer,
-                    screens: screenDel
+                    screens: screenDel,
+                    spaces: FakeSpaceObserver()
                 )
             }
 
@@ -0,0 +1,116 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class VisibleWindowsSpec: QuickSpec {
+    override func spec() {
+
+        var left: FakeScreen!
+        var right: FakeScreen!
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var fakeWindow: FakeWindow!
+        var otherWindow: FakeWindow!
+        beforeEach {
+            left = FakeScreen(frame: CGRect(x: 0, y: 0, width: 1000, height: 1000),
+                              menuBarHeight: 0, dockHeight: 0)
+            right = FakeScreen(frame: CGRect(x: 1000, y: 0, width: 1000, height: 1000),
+                               menuBarHeight: 0, dockHeight: 0)
+            waitUntil { done in
+                FakeState.initialize(screens: [left, right])
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .then {
+                        FakeWindowBuilder(parent: fakeApp)
+                            .setFrame(CGRect(x: 100, y: 100, width: 200, height: 200))
+                            .build()
+                    }
+                    .map { fakeWindow = $0 }
+                    .then {
+                        FakeWindowBuilder(parent: fakeApp)
+                            .setFrame(CGRect(x: 1100, y: 100, width: 200, height: 200))
+                            .build()
+                    }
+                    .map { otherWindow = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        func visible() -> [Window] {
+            return fakeState.state.visibleWindows
+        }
+
+        it("includes windows on screen") {
+            expect(visible()).to(contain(fakeWindow.window, otherWindow.window))
+            expect(fakeApp.application.visibleWindows).to(haveCount(2))
+        }
+
+        it("indexes windows by screen") {
+            expect(fakeState.state.visibleWindows(on: left.screen)).to(equal([fakeWindow.window]))
+            expect(fakeState.state.visibleWindows(on: right.screen)).to(equal([otherWindow.window]))
+        }
+
+        it("follows windows between screens") {
+            waitUntil { done in
+                fakeWindow.window.frame.set(CGRect(x: 1500, y: 100, width: 200, height: 200))
+                    .done { _ in done() }
+                    .cauterize()
+            }
+            expect(fakeState.state.visibleWindows(on: left.screen)).to(beEmpty())
+            expect(fakeState.state.visibleWindows(on: right.screen)).to(haveCount(2))
+        }
+
+        it("excludes windows that move off screen") {
+            waitUntil { done in
+                fakeWindow.window.frame.set(CGRect(x: 5000, y: 5000, width: 200, height: 200))
+                    .done { _ in done() }
+                    .cauterize()
+            }
+            expect(visible()).to(equal([otherWindow.window]))
+        }
+
+        it("excludes minimized windows") {
+            fakeWindow.isMinimized = true
+            expect(visible()).toEventually(equal([otherWindow.window]))
+            fakeWindow.isMinimized = false
+            expect(visible()).toEventually(haveCount(2))
+        }
+
+        it("excludes the windows of hidden applications") {
+            fakeApp.isHidden = true
+            expect(visible()).toEventually(beEmpty())
+            expect(fakeApp.application.visibleWindows).to(beEmpty())
+            fakeApp.isHidden = false
+            expect(visible()).toEventually(haveCount(2))
+        }
+
+        it("excludes destroyed windows") {
+            otherWindow.element.destroy()
+            expect(visible()).toEventually(equal([fakeWindow.window]))
+        }
+
+        it("includes new windows") {
+            waitUntil { done in
+                FakeWindowBuilder(parent: fakeApp)
+                    .setFrame(CGRect(x: 300, y: 300, width: 200, height: 200))
+                    .build()
+                    .done { _ in done() }
+                    .cauterize()
+            }
+            expect(visible()).toEventually(haveCount(3))
+        }
+
+        it("is a dependency of derived values") {
+            let count = DerivedValue { fakeState.state.visibleWindows.count }
+            expect(count.value).to(equal(2))
+            fakeWindow.isMinimized = true
+            expect(count.value).toEventually(equal(1))
+        }
+
+    }
+}
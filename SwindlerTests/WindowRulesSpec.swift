@@ -0,0 +1,116 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class WindowRulesSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        var editor: FakeWindow!
+        var palette: FakeWindow!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .then {
+                        FakeWindowBuilder(parent: fakeApp)
+                            .setTitle("main.swift — Editor")
+                            .setSize(CGSize(width: 1200, height: 800))
+                            .build()
+                    }
+                    .map { editor = $0 }
+                    .then {
+                        FakeWindowBuilder(parent: fakeApp)
+                            .setTitle("Colors")
+                            .setSize(CGSize(width: 200, height: 300))
+                            .build()
+                    }
+                    .map { palette = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        let rules = [
+            WindowRule(name: "editors", titlePattern: "Editor$"),
+            WindowRule(name: "small", maximumSize: CGSize(width: 400, height: 400)),
+            WindowRule(name: "everything"),
+            WindowRule(name: "dialogs", subrole: "AXDialog"),
+        ]
+
+        describe("WindowRuleSet") {
+            it("returns matching rules in order") {
+                let ruleSet = try! WindowRuleSet(rules)
+                expect(ruleSet.matches(editor.window).map { $0.name })
+                    .to(equal(["editors", "everything"]))
+                expect(ruleSet.matches(palette.window).map { $0.name })
+                    .to(equal(["small", "everything"]))
+            }
+
+            it("only applies bundle-specific rules to that bundle") {
+                let ruleSet = try! WindowRuleSet([
+                    WindowRule(name: "other app", bundleIdentifier: "com.example.Other"),
+                    WindowRule(name: "everything"),
+                ])
+                expect(ruleSet.matches(editor.window).map { $0.name }).to(equal(["everything"]))
+            }
+
+            it("rejects invalid title patterns") {
+                expect { try WindowRuleSet([WindowRule(name: "bad", titlePattern: "(")]) }
+                    .to(throwError())
+            }
+        }
+
+        describe("WindowRuleMatcher") {
+            var changes: [(Window, [String])]!
+            var matcher: WindowRuleMatcher!
+            beforeEach {
+                changes = []
+                matcher = WindowRuleMatcher(ruleSet: try! WindowRuleSet(rules),
+                                            state: fakeState.state) { window, rules in
+                    changes.append((window, rules.map { $0.name }))
+                }
+            }
+
+            it("evaluates existing windows") {
+                expect(changes).to(haveCount(2))
+                expect(matcher.matchingRules(for: editor.window).map { $0.name })
+                    .to(equal(["editors", "everything"]))
+            }
+
+            it("evaluates new windows") { () -> Promise<Void> in
+                FakeWindowBuilder(parent: fakeApp).setTitle("other.swift — Editor").build()
+                    .done { window in
+                        expect(changes).to(haveCount(3))
+                        expect(changes.last?.0).to(equal(window.window))
+                        expect(changes.last?.1).to(equal(["editors", "everything"]))
+                    }
+            }
+
+            it("re-evaluates windows when their title changes") {
+                palette.title = "scratch — Editor"
+                expect(changes).toEventually(haveCount(3))
+                expect(changes.last?.1).to(equal(["editors", "small", "everything"]))
+            }
+
+            it("re-evaluates windows when their size changes") {
+                palette.frame.size = CGSize(width: 500, height: 500)
+                expect(changes).toEventually(haveCount(3))
+                expect(changes.last?.1).to(equal(["everything"]))
+            }
+
+            it("does not report unchanged matches") {
+                editor.title = "other.swift — Editor"
+                expect(editor.window.title.value).toEventually(equal("other.swift — Editor"))
+                expect(changes).to(haveCount(2))
+            }
+        }
+
+    }
+}
@@ -10,6 +10,31 @@ import PromiseKit
 // ensure it doesn't get destroyed. Same for app -> state. See #3.
 private let stubApplicationDelegate = StubApplicationDelegate()
 
+// Fails bulk reads with `readError` once it is set, while single attribute reads still work.
+// Counts the bulk reads.
+private class FailingReadbackWindowElement: TestWindowElement {
+    var readError: Error?
+
+    private let lock = NSLock()
+    private var bulkReads_ = 0
+    var bulkReads: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return bulkReads_
+    }
+
+    override func getMultipleAttributes(_ attributes: [AXSwift.Attribute])
+        throws -> [Attribute: Any] {
+        lock.lock()
+        bulkReads_ += 1
+        lock.unlock()
+        if let error = readError {
+            throw error
+        }
+        return try super.getMultipleAttributes(attributes)
+    }
+}
+
 class OSXWindowDelegateInitializeSpec: QuickSpec {
     override func spec() {
 
@@ -22,14 +47,17 @@ class OSXWindowDelegateInitializeSpec: QuickSpec {
             windowElement = TestWindowElement(forApp: TestApplicationElement())
         }
 
-        func initializeWithElement(_ winElement: TestWindowElement) -> Promise<WinDelegate> {
+        func initializeWithElement(_ winElement: TestWindowElement,
+                                   notifier: TestNotifier = TestNotifier(),
+                                   lazyProperties: Bool = false) -> Promise<WinDelegate> {
             let screen = FakeScreen(frame: CGRect(x: 0, y: 0, width: 1000, height: 1000))
             let systemScreens = FakeSystemScreenDelegate(screens: [screen.delegate])
             return WinDelegate.initialize(appDelegate: stubApplicationDelegate,
-                                          notifier: TestNotifier(),
+                                          notifier: notifier,
                                           axElement: winElement,
                                           observer: TestObserver(),
-                                          systemScreens: systemScreens)
+                                          systemScreens: systemScreens,
+                                          lazyProperties: lazyProperties)
         }
 
         func initialize() -> Promise<WinDelegate> {
@@ -102,6 +130,191 @@ class OSXWindowDelegateInitializeSpec: QuickSpec {
 
         }
 
+        describe("lazy properties") {
+            var notifier: TestNotifier!
+            beforeEach {
+                notifier = TestNotifier()
+                windowElement.attrs[.title] = "a window title"
+            }
+
+            func initializeLazily() -> WinDelegate {
+                var windowDelegate: WinDelegate!
+                waitUntil { done in
+                    initializeWithElement(windowElement, notifier: notifier, lazyProperties: true)
+                        .done { windowDelegate = $0; done() }
+                        .cauterize()
+                }
+                return windowDelegate
+            }
+
+            it("initializes the frame and isMinimized eagerly") {
+                let windowDelegate = initializeLazily()
+                expect(windowDelegate.frame.initialized.isFulfilled).to(beTrue())
+                expect(windowDelegate.isMinimized.initialized.isFulfilled).to(beTrue())
+                expect(windowDelegate.title.initialized.isPending).to(beTrue())
+                expect(windowDelegate.isFullscreen.initialized.isPending).to(beTrue())
+            }
+
+            it("reads the other properties when they are first read") {
+                let windowDelegate = initializeLazily()
+                windowElement.attrs[.title] = "read later"
+                expect(windowDelegate.title.value) == "read later"
+                expect(windowDelegate.isFullscreen.value).to(beFalse())
+                expect(windowDelegate.title.initialized.isFulfilled).toEventually(beTrue())
+            }
+
+            it("uses placeholders if the window can't be read") {
+                let windowDelegate = initializeLazily()
+                windowElement.throwInvalid = true
+                expect(windowDelegate.title.value) == ""
+                expect(windowDelegate.isFullscreen.value).to(beFalse())
+                expect(windowDelegate.title.initialized.isPending).to(beTrue())
+            }
+
+            it("reads them again in the background after a read fails") {
+                let windowDelegate = initializeLazily()
+                windowDelegate.lazyAttributes?.retryDelay = 0.05
+                windowElement.throwInvalid = true
+                expect(windowDelegate.title.value) == ""
+
+                windowElement.throwInvalid = false
+                windowElement.attrs[.title] = "read again"
+                expect(windowDelegate.title.value).toEventually(equal("read again"))
+                expect(windowDelegate.title.initialized.isFulfilled).toEventually(beTrue())
+                expect(windowDelegate.isFullscreen.initialized.isFulfilled).toEventually(beTrue())
+            }
+
+            it("doesn't block on the application again after a read fails") {
+                let element = FailingReadbackWindowElement(forApp: TestApplicationElement())
+                var windowDelegate: WinDelegate!
+                waitUntil { done in
+                    initializeWithElement(element, notifier: notifier, lazyProperties: true)
+                        .done { windowDelegate = $0; done() }
+                        .cauterize()
+                }
+                windowDelegate.lazyAttributes?.retryDelay = 10
+                element.readError = AXError.cannotComplete
+                let reads = element.bulkReads
+
+                expect(windowDelegate.title.value) == ""
+                expect(windowDelegate.title.value) == ""
+                expect(windowDelegate.isFullscreen.value).to(beFalse())
+                expect(element.bulkReads) == reads + 1
+            }
+
+            it("reads them again when refreshed after a read fails") { () -> Promise<Void> in
+                let windowDelegate = initializeLazily()
+                windowElement.throwInvalid = true
+                return expectToFail(windowDelegate.title.refresh()).then { () -> Promise<String> in
+                    windowElement.throwInvalid = false
+                    return windowDelegate.title.refresh()
+                }.done { title in
+                    expect(title) == "a window title"
+                    expect(windowDelegate.title.initialized.isFulfilled).to(beTrue())
+                }
+            }
+
+            context("when a property changes before it is read") {
+                it("reads it without emitting an event") {
+                    let windowDelegate = initializeLazily()
+                    windowElement.attrs[.title] = "changed"
+                    windowDelegate.handleEvent(.titleChanged, observer: TestObserver())
+                    expect(windowDelegate.title.initialized.isFulfilled).toEventually(beTrue())
+                    expect(windowDelegate.title.value) == "changed"
+                    expect(notifier.getEventsOfType(WindowTitleChangedEvent.self)).to(beEmpty())
+
+                    windowElement.attrs[.title] = "changed again"
+                    windowDelegate.handleEvent(.titleChanged, observer: TestObserver())
+                    notifier.expectEvent(WindowTitleChangedEvent.self)
+                }
+            }
+
+            context("when title events are being listened for") {
+                it("reads the title eagerly") {
+                    notifier.on { (_: WindowTitleChangedEvent) in }
+                    let windowDelegate = initializeLazily()
+                    expect(windowDelegate.title.initialized.isFulfilled).to(beTrue())
+                }
+            }
+
+            context("when a title event handler is added later") {
+                it("reads the titles of existing windows") {
+                    var configuration = Swindler.Configuration()
+                    configuration.lazyWindowProperties = true
+                    var fakeWindow: FakeWindow!
+                    waitUntil { done in
+                        FakeState.initialize(configuration: configuration)
+                            .then { FakeApplicationBuilder(parent: $0).build() }
+                            .then { FakeWindowBuilder(parent: $0).build() }
+                            .done { fakeWindow = $0; done() }
+                            .cauterize()
+                    }
+                    let title = fakeWindow.window.delegate.title!
+                    expect(title.initialized.isPending).to(beTrue())
+
+                    fakeWindow.window.application.swindlerState.on {
+                        (_: WindowTitleChangedEvent) in
+                    }
+                    expect(title.initialized.isFulfilled).toEventually(beTrue())
+                }
+            }
+        }
+
+        describe("apply") {
+            var element: FailingReadbackWindowElement!
+            var winDelegate: WinDelegate!
+            beforeEach {
+                element = FailingReadbackWindowElement(forApp: TestApplicationElement())
+                waitUntil { done in
+                    initializeWithElement(element).done { winDelegate = $0; done() }.cauterize()
+                }
+            }
+
+            it("doesn't mark the window invalid on a timeout") { () -> Promise<Void> in
+                element.readError = AXError.cannotComplete
+                return expectToFail(winDelegate.apply(WindowChanges(isMinimized: true)),
+                                    with: PropertyError.timeout(time: -1)).done {
+                    expect(winDelegate.isValid).to(beTrue())
+                }
+            }
+
+            it("marks the window invalid when it is gone") { () -> Promise<Void> in
+                element.readError = AXError.invalidUIElement
+                return expectToFail(winDelegate.apply(WindowChanges(isMinimized: true))).done {
+                    expect(winDelegate.isValid).to(beFalse())
+                }
+            }
+        }
+
+        describe("prefetching") {
+            it("doesn't overwrite a value stored while it was reading") {
+                let element = AdversaryWindowElement(forApp: TestApplicationElement())
+                element.attrs[.title] = "initial"
+                var winDelegate: WinDelegate!
+                waitUntil { done in
+                    initializeWithElement(element).done { winDelegate = $0; done() }.cauterize()
+                }
+
+                element.attrs[.title] = "stale"
+                element.onAttributeFirstRead(.title) {
+                    // After the prefetch has read "stale", a newer title is stored before the
+                    // prefetch gets back to the main thread.
+                    let title = winDelegate.title!
+                    _ = title.update(fromPolled: [.title: "fresh"],
+                                     ifUnchangedSince: title.changeSequence)
+                }
+                var outcome: PollOutcome?
+                waitUntil { done in
+                    winDelegate.pollForChanges(qos: .userInitiated)
+                        .done { outcome = $0; done() }
+                        .cauterize()
+                }
+
+                expect(winDelegate.title.value).to(equal("fresh"))
+                expect(outcome?.changedWindows).to(equal(0))
+            }
+        }
+
         describe("Window equality") {
 
             it("returns true for identical WindowDelegates") { () -> Promise<Void> in
@@ -538,5 +751,76 @@ class WindowSpec: QuickSpec {
             }
         }
 
+        describe("apply(changes:)") {
+            var fakeState: FakeState!
+            var fakeApp: FakeApplication!
+            var fakeWindow: FakeWindow!
+            var otherWindow: FakeWindow!
+            beforeEach {
+                waitUntil { done in
+                    FakeState.initialize()
+                        .map { fakeState = $0 }
+                        .then { FakeApplicationBuilder(parent: fakeState).build() }
+                        .map { fakeApp = $0 }
+                        .then { FakeWindowBuilder(parent: fakeApp).setMinimized().build() }
+                        .map { fakeWindow = $0 }
+                        .then { FakeWindowBuilder(parent: fakeApp).build() }
+                        .map { otherWindow = $0 }
+                        .done { done() }
+                        .cauterize()
+                }
+                fakeApp.mainWindow = otherWindow
+                expect(fakeApp.application.mainWindow.value)
+                    .toEventually(equal(otherWindow.window))
+            }
+
+            func apply(_ changes: WindowChanges) {
+                waitUntil { done in
+                    fakeWindow.window.apply(changes: changes).done { done() }.cauterize()
+                }
+            }
+
+            it("restores a window in one operation") {
+                var events: [EventType] = []
+                fakeState.state.on { (event: WindowMinimizedChangedEvent) in events.append(event) }
+                fakeState.state.on { (event: WindowFrameChangedEvent) in events.append(event) }
+                fakeState.state.on { (event: ApplicationMainWindowChangedEvent) in
+                    events.append(event)
+                }
+
+                let frame = CGRect(x: 200, y: 200, width: 500, height: 400)
+                apply(WindowChanges(frame: frame, isMinimized: false, makeMain: true))
+
+                let window = fakeWindow.window
+                expect(window.isMinimized.value).to(beFalse())
+                expect(window.frame.value).to(equal(frame))
+                expect(fakeApp.application.mainWindow.value).to(equal(window))
+                expect(fakeWindow.isMinimized).to(beFalse())
+                expect(fakeWindow.frame).to(equal(frame))
+
+                expect(events).to(haveCount(3))
+                expect(events.allSatisfy { !$0.external }).to(beTrue())
+            }
+
+            it("leaves unspecified properties alone") {
+                let frame = fakeWindow.window.frame.value
+                apply(WindowChanges(isMinimized: false))
+                expect(fakeWindow.window.isMinimized.value).to(beFalse())
+                expect(fakeWindow.window.frame.value).to(equal(frame))
+                expect(fakeApp.application.mainWindow.value).to(equal(otherWindow.window))
+            }
+
+            it("fails on an invalid window") {
+                fakeWindow.element.throwInvalid = true
+                var error: Error?
+                waitUntil { done in
+                    fakeWindow.window.apply(changes: WindowChanges(isMinimized: false))
+                        .catch { error = $0; done() }
+                }
+                expect(error).toNot(beNil())
+                expect(fakeWindow.window.isValid).to(beFalse())
+            }
+        }
+
     }
 }
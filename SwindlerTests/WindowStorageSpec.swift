@@ -0,0 +1,61 @@
+import Cocoa
+import Quick
+import Nimble
+
+@testable import Swindler
+import PromiseKit
+
+class WindowStorageSpec: QuickSpec {
+    override func spec() {
+
+        var fakeState: FakeState!
+        var fakeApp: FakeApplication!
+        beforeEach {
+            waitUntil { done in
+                FakeState.initialize()
+                    .map { fakeState = $0 }
+                    .then { FakeApplicationBuilder(parent: fakeState).build() }
+                    .map { fakeApp = $0 }
+                    .done { done() }
+                    .cauterize()
+            }
+        }
+
+        it("shares one set of locks between the properties of a window") { () -> Promise<Void> in
+            FakeWindowBuilder(parent: fakeApp).build().done { fakeWindow in
+                let window = fakeWindow.window
+                expect(window.title.locks).to(beIdenticalTo(window.frame.locks))
+                expect(window.isMinimized.locks).to(beIdenticalTo(window.frame.locks))
+                expect(window.size.locks).to(beIdenticalTo(window.frame.locks))
+            }
+        }
+
+        it("does not share locks between windows") { () -> Promise<Void> in
+            when(fulfilled: FakeWindowBuilder(parent: fakeApp).build(),
+                 FakeWindowBuilder(parent: fakeApp).build()).done { first, second in
+                expect(first.window.frame.locks)
+                    .toNot(beIdenticalTo(second.window.frame.locks))
+            }
+        }
+
+        describe("memory") {
+            it("stays within its per-window budget") {
+                let windowCount = 500
+                // Build the fake elements first, so only Swindler's own storage is measured.
+                let builders = (0..<windowCount).map { _ in FakeWindowBuilder(parent: fakeApp) }
+
+                let before = bytesInUse()
+                waitUntil(timeout: 10) { done in
+                    when(fulfilled: builders.map { $0.build() }).done { _ in done() }.cauterize()
+                }
+                let perWindow = (bytesInUse() - before) / windowCount
+                expect(fakeState.state.knownWindows).to(haveCount(windowCount))
+
+                // The delegate, four properties with their promises and boxes, one shared pair of
+                // locks, and the application's bookkeeping for the window.
+                expect(perWindow).to(beLessThan(6 * 1024))
+            }
+        }
+
+    }
+}
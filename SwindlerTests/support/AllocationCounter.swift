@@ -0,0 +1,55 @@
+import Darwin
+
+/// Counts heap allocations made on the main thread while `body` runs.
+///
+/// Works by installing a `malloc_logger`, which malloc calls on every allocation, for the duration
+/// of `body`, and restoring the previous one afterwards. Allocations made by other threads are not
+/// counted. Only meant for benchmarks.
+func countAllocations(_ body: () throws -> Void) rethrows -> Int {
+    assert(pthread_main_np() != 0)
+    let logger = mallocLogger()
+    previousLogger = logger.pointee
+    allocationCount = 0
+    logger.pointee = countingLogger
+    defer {
+        logger.pointee = previousLogger
+        previousLogger = nil
+    }
+    try body()
+    return allocationCount
+}
+
+// void malloc_logger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3,
+//                    uintptr_t result, uint32_t num_hot_frames_to_skip)
+private typealias MallocLogger = @convention(c) (UInt32, UInt, UInt, UInt, UInt, UInt32) -> Void
+
+// MALLOC_LOG_TYPE_ALLOCATE, set for malloc, calloc, realloc and memalign.
+private let mallocLogTypeAllocate: UInt32 = 2
+
+private var allocationCount = 0
+// Another logger that was installed, such as the one used by MallocStackLogging.
+private var previousLogger: MallocLogger?
+
+// Must not allocate.
+private let countingLogger: MallocLogger = { type, arg1, arg2, arg3, result, skip in
+    if type & mallocLogTypeAllocate != 0 && pthread_main_np() != 0 {
+        allocationCount += 1
+    }
+    previousLogger?(type, arg1, arg2, arg3, result, skip)
+}
+
+// `malloc_logger` isn't in the public headers, so it is looked up at run time.
+private func mallocLogger() -> UnsafeMutablePointer<MallocLogger?> {
+    let defaultHandle = UnsafeMutableRawPointer(bitPattern: -2)  // RTLD_DEFAULT
+    guard let symbol = dlsym(defaultHandle, "malloc_logger") else {
+        fatalError("couldn't find malloc_logger")
+    }
+    return symbol.assumingMemoryBound(to: Optional<MallocLogger>.self)
+}
+
+/// The number of bytes currently allocated from all malloc zones.
+func bytesInUse() -> Int {
+    var stats = malloc_statistics_t()
+    malloc_zone_statistics(nil, &stats)
+    return stats.size_in_use
+}